@@ -11,6 +11,7 @@
 #include "zcl_app.h"
 #include "factory_reset.h"
 #include "commissioning.h"
+#include "rejoin.h"
 #include "Debug.h"
 
 #if defined ( MT_TASK )
@@ -30,7 +31,7 @@ const pTaskEventHandlerFn tasksArr[] = {macEventLoop,
                                         bdb_event_loop,
                                         zclApp_event_loop,
                                         zclFactoryResetter_loop,
-                                        zclCommissioning_event_loop
+                                        zclRejoin_CommissioningLoop
                                         };
 
 const uint8 tasksCnt = sizeof(tasksArr) / sizeof(tasksArr[0]);
@@ -0,0 +1,221 @@
+#include "hal_adc.h"
+#include "hal_dma.h"
+#include "hal_mcu.h"
+
+#include "adc_sequence.h"
+
+/*********************************************************************
+ * MACROS
+ */
+#define ADC_SEQUENCE_STSEL_MASK 0x30
+#define ADC_SEQUENCE_STSEL_FULL_SPEED 0x10 // run sequences back to back, DMA takes results
+#define ADC_SEQUENCE_STSEL_ST 0x30         // idle, wait for ADCCON1.ST
+
+#define ADC_SEQUENCE_SDIV_064 0x00
+#define ADC_SEQUENCE_SDIV_128 0x10
+#define ADC_SEQUENCE_SDIV_256 0x20
+#define ADC_SEQUENCE_SDIV_512 0x30
+
+#define ADC_SEQUENCE_DMA_ARMED() (DMAARM & BV(HAL_DMA_CH_ADC))
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+typedef struct {
+    uint8 channels; // mask of AIN channels
+    uint8 count;    // channels in mask, stride of samples in buffer
+    uint8 samples;
+    uint8 offset; // first word in buffer
+} adcSequence_Run_t;
+
+typedef struct {
+    int32 sum;
+    uint16 min;
+    uint16 max;
+    uint8 samples;
+} adcSequence_Stats_t;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+static uint16 adcSequenceBuffer[ADC_SEQUENCE_BUFFER_SIZE];
+static adcSequence_Run_t adcSequenceRuns[ADC_SEQUENCE_RUNS];
+static uint8 adcSequenceRunsCount = 0;
+static uint8 adcSequenceUsed = 0;    // words of buffer taken by runs
+static uint8 adcSequenceControl = 0; // ADCCON2 reference and decimation, same for all runs
+static uint8 adcSequenceShift = 0;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static bool adcSequence_StartRun(uint8 channelsMask, uint8 samples);
+static void adcSequence_Scan(uint8 channel, adcSequence_Stats_t *stats);
+
+bool adcSequence_Start(uint8 channelsMask, uint8 resolution, uint8 reference, uint8 samples) {
+    uint8 sdiv;
+
+    switch (resolution) {
+    case HAL_ADC_RESOLUTION_8:
+        sdiv = ADC_SEQUENCE_SDIV_064;
+        adcSequenceShift = 8;
+        break;
+    case HAL_ADC_RESOLUTION_10:
+        sdiv = ADC_SEQUENCE_SDIV_128;
+        adcSequenceShift = 6;
+        break;
+    case HAL_ADC_RESOLUTION_12:
+        sdiv = ADC_SEQUENCE_SDIV_256;
+        adcSequenceShift = 4;
+        break;
+    case HAL_ADC_RESOLUTION_14:
+    default:
+        sdiv = ADC_SEQUENCE_SDIV_512;
+        adcSequenceShift = 2;
+        break;
+    }
+    adcSequenceControl = reference | sdiv;
+    adcSequenceRunsCount = 0;
+    adcSequenceUsed = 0;
+    return adcSequence_StartRun(channelsMask, samples);
+}
+
+bool adcSequence_Extend(uint8 channelsMask, uint8 samples) {
+    uint8 count = 0;
+    if (adcSequenceRunsCount == 0 || adcSequenceRunsCount >= ADC_SEQUENCE_RUNS) {
+        return FALSE;
+    }
+    for (uint8 i = 0; i < 8; i++) {
+        if (channelsMask & BV(i)) {
+            count++;
+        }
+    }
+    // as many as fit, a few more samples are still better than none
+    if (count > 0 && (uint16)count * samples > ADC_SEQUENCE_BUFFER_SIZE - adcSequenceUsed) {
+        samples = (ADC_SEQUENCE_BUFFER_SIZE - adcSequenceUsed) / count;
+    }
+    return adcSequence_StartRun(channelsMask, samples);
+}
+
+static bool adcSequence_StartRun(uint8 channelsMask, uint8 samples) {
+    adcSequence_Run_t *run = &adcSequenceRuns[adcSequenceRunsCount];
+    uint8 lastChannel = 0;
+    halDMADesc_t *ch;
+
+    run->count = 0;
+    for (uint8 i = 0; i < 8; i++) {
+        if (channelsMask & BV(i)) {
+            run->count++;
+            lastChannel = i;
+        }
+    }
+    if (run->count == 0 || samples == 0 || (uint16)run->count * samples > ADC_SEQUENCE_BUFFER_SIZE - adcSequenceUsed) {
+        return FALSE;
+    }
+    run->channels = channelsMask;
+    run->samples = samples;
+    run->offset = adcSequenceUsed;
+    adcSequenceUsed += run->count * samples;
+    adcSequenceRunsCount++;
+
+    ch = HAL_DMA_GET_DESC1234(HAL_DMA_CH_ADC);
+    HAL_DMA_SET_SOURCE(ch, &X_ADCL);
+    HAL_DMA_SET_DEST(ch, &adcSequenceBuffer[run->offset]);
+    HAL_DMA_SET_VLEN(ch, HAL_DMA_VLEN_USE_LEN);
+    HAL_DMA_SET_LEN(ch, run->count * samples);
+    HAL_DMA_SET_WORD_SIZE(ch, HAL_DMA_WORDSIZE_WORD);
+    HAL_DMA_SET_TRIG_MODE(ch, HAL_DMA_TMODE_SINGLE);
+    HAL_DMA_SET_TRIG_SRC(ch, HAL_DMA_TRIG_ADC_CHALL);
+    HAL_DMA_SET_SRC_INC(ch, HAL_DMA_SRCINC_0);
+    HAL_DMA_SET_DST_INC(ch, HAL_DMA_DSTINC_1);
+    HAL_DMA_SET_IRQ(ch, HAL_DMA_IRQMASK_DISABLE);
+    HAL_DMA_SET_M8(ch, HAL_DMA_M8_USE_8_BITS);
+    HAL_DMA_SET_PRIORITY(ch, HAL_DMA_PRI_HIGH);
+    HAL_DMA_CLEAR_IRQ(HAL_DMA_CH_ADC);
+    HAL_DMA_ARM_CH(HAL_DMA_CH_ADC);
+
+    /**
+     * FYI: sequence always runs from AIN0 to ADCCON2.SCH,
+     * channels not enabled in APCFG are skipped, so only channelsMask is converted
+     * */
+    APCFG = channelsMask;
+    ADCCON2 = adcSequenceControl | lastChannel;
+    ADCCON1 = (ADCCON1 & ~ADC_SEQUENCE_STSEL_MASK) | ADC_SEQUENCE_STSEL_FULL_SPEED;
+    return TRUE;
+}
+
+bool adcSequence_IsDone(void) { return !ADC_SEQUENCE_DMA_ARMED(); }
+
+bool adcSequence_Stop(void) {
+    bool done = adcSequence_IsDone();
+    ADCCON1 = (ADCCON1 & ~ADC_SEQUENCE_STSEL_MASK) | ADC_SEQUENCE_STSEL_ST;
+    if (!done) {
+        HAL_DMA_ABORT_CH(HAL_DMA_CH_ADC);
+    }
+    if (adcSequenceRunsCount > 0) {
+        APCFG &= ~adcSequenceRuns[adcSequenceRunsCount - 1].channels;
+    }
+    return done;
+}
+
+static void adcSequence_Scan(uint8 channel, adcSequence_Stats_t *stats) {
+    stats->sum = 0;
+    stats->min = 0xFFFF;
+    stats->max = 0;
+    stats->samples = 0;
+    for (uint8 r = 0; r < adcSequenceRunsCount; r++) {
+        adcSequence_Run_t *run = &adcSequenceRuns[r];
+        uint8 position = 0;
+        if (!(run->channels & BV(channel))) {
+            continue;
+        }
+        for (uint8 i = 0; i < channel; i++) {
+            if (run->channels & BV(i)) {
+                position++;
+            }
+        }
+        for (uint8 i = 0; i < run->samples; i++) {
+            int16 reading = (int16)adcSequenceBuffer[run->offset + i * run->count + position];
+            // treat small negative as 0, same as HalAdcRead
+            uint16 value = reading > 0 ? (uint16)(reading >> adcSequenceShift) : 0;
+            stats->sum += value;
+            if (value < stats->min) {
+                stats->min = value;
+            }
+            if (value > stats->max) {
+                stats->max = value;
+            }
+            stats->samples++;
+        }
+    }
+}
+
+uint16 adcSequence_Result(uint8 channel) {
+    adcSequence_Stats_t stats;
+    adcSequence_Scan(channel, &stats);
+    if (stats.samples == 0) {
+        return 0;
+    }
+    if (stats.samples < 3) {
+        return (uint16)(stats.sum / stats.samples);
+    }
+    // trimmed mean, a single spike doesn't move it, for 3 samples it's the median
+    return (uint16)((stats.sum - stats.min - stats.max) / (stats.samples - 2));
+}
+
+uint8 adcSequence_Samples(uint8 channel) {
+    adcSequence_Stats_t stats;
+    adcSequence_Scan(channel, &stats);
+    return stats.samples;
+}
+
+uint8 adcSequence_NoisyChannels(uint16 spread) {
+    adcSequence_Stats_t stats;
+    uint8 noisy = 0;
+    for (uint8 i = 0; i < 8; i++) {
+        adcSequence_Scan(i, &stats);
+        if (stats.samples > 0 && stats.max - stats.min > spread) {
+            noisy |= BV(i);
+        }
+    }
+    return noisy;
+}
@@ -0,0 +1,69 @@
+#ifndef ADC_SEQUENCE_H
+#define ADC_SEQUENCE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "hal_types.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// words of DMA buffer, channels count * samples should fit, e.g. light and 3 soil channels 5 times
+#ifndef ADC_SEQUENCE_BUFFER_SIZE
+#define ADC_SEQUENCE_BUFFER_SIZE 20
+#endif
+
+// first run and one adcSequence_Extend for noisy channels
+#define ADC_SEQUENCE_RUNS 2
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+
+/*
+ * Starts ADC sequence conversion of AIN channels from channelsMask (bit per AIN0..AIN7), repeated samples times.
+ * Results are moved to buffer by DMA, so CPU is free until adcSequence_Stop.
+ * resolution and reference are HAL_ADC_RESOLUTION_* and HAL_ADC_REF_* from hal_adc.h
+ */
+extern bool adcSequence_Start(uint8 channelsMask, uint8 resolution, uint8 reference, uint8 samples);
+
+/*
+ * TRUE when all samples are in buffer
+ */
+extern bool adcSequence_IsDone(void);
+
+/*
+ * Stops ADC and DMA, returns FALSE if sequence wasn't complete
+ */
+extern bool adcSequence_Stop(void);
+
+/*
+ * Appends one more run of samples for channelsMask, e.g. noisy ones, with resolution and reference of adcSequence_Start.
+ * Call after adcSequence_Stop, samples are reduced to what is left of buffer
+ */
+extern bool adcSequence_Extend(uint8 channelsMask, uint8 samples);
+
+/*
+ * Mean of samples for channel of all runs, without the lowest and the highest one when there are 3 or more,
+ * scaled like HalAdcRead for the same resolution
+ */
+extern uint16 adcSequence_Result(uint8 channel);
+
+/*
+ * Samples converted for channel in all runs
+ */
+extern uint8 adcSequence_Samples(uint8 channel);
+
+/*
+ * Mask of channels whose samples differ by more than spread
+ */
+extern uint8 adcSequence_NoisyChannels(uint16 spread);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ADC_SEQUENCE_H */
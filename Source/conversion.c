@@ -0,0 +1,111 @@
+#include "conversion.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+#define CONVERSION_MAX_DECIMAL_SCALE 9
+
+// mantissa table steps, linear interpolation between them adds a few units of error
+#define CONVERSION_LOG_STEPS 16
+#define CONVERSION_LOG_STEP_BITS 4
+#define CONVERSION_LOG10_2_X10 30103 // 10 * CONVERSION_LOG_SCALE * log10(2)
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+static const uint32 powersOfTen[CONVERSION_MAX_DECIMAL_SCALE + 1] = {1UL,      10UL,      100UL,      1000UL,      10000UL,
+                                                                     100000UL, 1000000UL, 10000000UL, 100000000UL, 1000000000UL};
+
+// CONVERSION_LOG_SCALE * log10(1 + i / CONVERSION_LOG_STEPS)
+static const uint16 log10Mantissa[CONVERSION_LOG_STEPS + 1] = {0,    263,  512,  746,  969,  1181, 1383, 1576, 1761,
+                                                               1938, 2109, 2272, 2430, 2583, 2730, 2872, 3010};
+
+int16 scalePressure(uint32 pressure, int8 scale) {
+    uint32 scaled;
+    if (scale < 0) {
+        if (-scale > CONVERSION_MAX_DECIMAL_SCALE) {
+            return 0;
+        }
+        scaled = pressure / powersOfTen[-scale];
+    } else {
+        if (scale > CONVERSION_MAX_DECIMAL_SCALE || pressure > 0x7FFF / powersOfTen[scale]) {
+            return 0x7FFF;
+        }
+        scaled = pressure * powersOfTen[scale];
+    }
+    return scaled > 0x7FFF ? 0x7FFF : (int16)scaled;
+}
+
+uint16 mapSoilHumidity(uint16 rawAdc, uint16 airAdc, uint16 waterAdc) {
+    int32 range = (int32)waterAdc - (int32)airAdc;
+    int32 mapped;
+    if (range == 0) {
+        return 0;
+    }
+    // FYI: C division truncates towards zero, same as (uint16) cast of mapRange result
+    mapped = ((int32)rawAdc - (int32)airAdc) * CONVERSION_HUMIDITY_MAX / range;
+    if (mapped < 0) {
+        return 0;
+    }
+    if (mapped > CONVERSION_HUMIDITY_MAX) {
+        return CONVERSION_HUMIDITY_MAX;
+    }
+    return (uint16)mapped;
+}
+
+uint16 convertHumidity(uint32 humidity) { return (uint16)((humidity * 100) >> 10); }
+
+uint16 convertBatteryMv(uint16 rawAdc) {
+    return (uint16)(((uint32)rawAdc * (CONVERSION_VDD_DIVIDER * CONVERSION_VDD_REF_MV) + CONVERSION_ADC_FULL_SCALE / 2) /
+                    CONVERSION_ADC_FULL_SCALE);
+}
+
+uint8 convertBatteryZCL(uint16 millivolts) { return (uint8)((millivolts + 50) / 100); }
+
+uint16 convertSoilAirAdc(uint16 batteryAdc) {
+    return (uint16)(AIR_COMPENSATION_SLOPE * batteryAdc / COMPENSATION_SLOPE_DIVIDER + AIR_COMPENSATION_OFFSET);
+}
+
+uint16 convertSoilWaterAdc(uint16 batteryAdc) {
+    return (uint16)(WATER_COMPENSATION_SLOPE * batteryAdc / COMPENSATION_SLOPE_DIVIDER + WATER_COMPENSATION_OFFSET);
+}
+
+uint32 log10Scaled(uint32 value) {
+    uint8 exponent = 31;
+    if (value == 0) {
+        return 0;
+    }
+    // value = 2^exponent * mantissa, mantissa in [1..2) is left aligned in value, whole bytes first
+    while (!(value & 0xFF000000UL)) {
+        value <<= 8;
+        exponent -= 8;
+    }
+    while (!(value & 0x80000000UL)) {
+        value <<= 1;
+        exponent--;
+    }
+    uint8 step = (uint8)(value >> (31 - CONVERSION_LOG_STEP_BITS)) & (CONVERSION_LOG_STEPS - 1);
+    uint16 fraction = (uint16)(value >> (15 - CONVERSION_LOG_STEP_BITS));
+    uint16 low = log10Mantissa[step];
+    uint16 high = log10Mantissa[step + 1];
+    return (uint32)exponent * CONVERSION_LOG10_2_X10 / 10 + low + (uint16)(((uint32)(high - low) * fraction) >> 16);
+}
+
+uint16 convertIlluminance(uint16 rawAdc, uint16 referenceMv) {
+    int32 level;
+    if (rawAdc == 0) {
+        return 0;
+    }
+    // log10 of sensor uV = rawAdc * referenceMv * 1000 / full scale, products become sums
+    level = (int32)log10Scaled((uint32)rawAdc * referenceMv) + 3 * CONVERSION_LOG_SCALE;
+    level -= (int32)log10Scaled(CONVERSION_ADC_FULL_SCALE) + (int32)log10Scaled(LIGHT_UV_PER_LUX);
+    level = level * 100 / LIGHT_GAMMA + 1;
+    if (level < 1) {
+        // below 1 lux
+        return 0;
+    }
+    if (level > CONVERSION_ILLUMINANCE_MAX) {
+        return CONVERSION_ILLUMINANCE_MAX;
+    }
+    return (uint16)level;
+}
@@ -0,0 +1,98 @@
+#ifndef CONVERSION_H
+#define CONVERSION_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "hal_types.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// upper bound of relative humidity in ZCL units (0.01%)
+#define CONVERSION_HUMIDITY_MAX 10000
+
+// ZCL illuminance is 10000 * log10(lux) + 1, logarithms below use the same scale
+#define CONVERSION_LOG_SCALE 10000
+#define CONVERSION_ILLUMINANCE_MAX 0xFFFE
+
+// HalAdcRead and adcSequence_Result at 14 bit resolution
+#define CONVERSION_ADC_FULL_SCALE 8191
+
+// battery is measured as VDD/3 against internal reference, datasheet value is 1.15V
+#ifndef CONVERSION_VDD_REF_MV
+#define CONVERSION_VDD_REF_MV 1150
+#endif
+#define CONVERSION_VDD_DIVIDER 3
+
+// soil probe readings in air and water drift with battery voltage, slopes are multiplied by COMPENSATION_SLOPE_DIVIDER
+#define COMPENSATION_SLOPE_DIVIDER 1000UL
+#define AIR_COMPENSATION_SLOPE 179UL
+#define AIR_COMPENSATION_OFFSET 3926
+#define WATER_COMPENSATION_SLOPE 146UL
+#define WATER_COMPENSATION_OFFSET 2020
+
+// light sensor output, taken as proportional to lux^(LIGHT_GAMMA / 100), calibrate for sensor and its load resistor
+#ifndef LIGHT_UV_PER_LUX
+#define LIGHT_UV_PER_LUX 1000
+#endif
+#ifndef LIGHT_GAMMA
+#define LIGHT_GAMMA 100 // phototransistor is linear, photoresistor dividers are usually 60..90
+#endif
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+
+/*
+ * Integer replacement for (int16)(pow(10.0, scale) * pressure), saturates to int16
+ */
+extern int16 scalePressure(uint32 pressure, int8 scale);
+
+/*
+ * Linear map of soil probe ADC value from [airAdc..waterAdc] to [0..CONVERSION_HUMIDITY_MAX]
+ */
+extern uint16 mapSoilHumidity(uint16 rawAdc, uint16 airAdc, uint16 waterAdc);
+
+/*
+ * BME280 humidity (1/1024 %RH) to ZCL relative humidity (0.01 %RH)
+ */
+extern uint16 convertHumidity(uint32 humidity);
+
+/*
+ * Integer replacement for CONVERSION_LOG_SCALE * log10(value), value > 0, error is within 5 units (0.1 %)
+ */
+extern uint32 log10Scaled(uint32 value);
+
+/*
+ * Integer replacement for zstack-lib battery voltage math, VDD/3 ADC value at 14 bit to mV
+ */
+extern uint16 convertBatteryMv(uint16 rawAdc);
+
+/*
+ * Battery mV to ZCL BatteryVoltage (100 mV), rounded
+ */
+extern uint8 convertBatteryZCL(uint16 millivolts);
+
+/*
+ * Integer replacement for (uint16)(0.179 * batteryAdc + 3926.0), soil probe ADC value in air at given battery ADC value
+ */
+extern uint16 convertSoilAirAdc(uint16 batteryAdc);
+
+/*
+ * Integer replacement for (uint16)(0.146 * batteryAdc + 2020.0), soil probe ADC value in water at given battery ADC value
+ */
+extern uint16 convertSoilWaterAdc(uint16 batteryAdc);
+
+/*
+ * Light sensor ADC value measured against referenceMv to ZCL illuminance, 0 - too dark to be measured
+ */
+extern uint16 convertIlluminance(uint16 rawAdc, uint16 referenceMv);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONVERSION_H */
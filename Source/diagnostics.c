@@ -0,0 +1,75 @@
+#include "OSAL.h"
+#include "OSAL_Nv.h"
+#include "ZComDef.h"
+
+#include "Debug.h"
+#include "diagnostics.h"
+#include "energy.h"
+#include "zcl_app.h"
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+zclDiagnostics_Counters_t zclDiagnostics_Counters = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+uint32 zclDiagnostics_BootReportMs = 0;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+static uint8 cyclesSinceSave = 0;
+
+void zclDiagnostics_Init(void) {
+    uint16 len = osal_nv_item_len(NW_APP_DIAGNOSTICS);
+    if (len != 0 && len != sizeof(zclDiagnostics_Counters)) {
+        osal_nv_delete(NW_APP_DIAGNOSTICS, len);
+    }
+    if (osal_nv_item_init(NW_APP_DIAGNOSTICS, sizeof(zclDiagnostics_Counters), &zclDiagnostics_Counters) == SUCCESS) {
+        osal_nv_read(NW_APP_DIAGNOSTICS, 0, sizeof(zclDiagnostics_Counters), &zclDiagnostics_Counters);
+    }
+    LREP("Diagnostics wakeUps=%ld framesSent=%ld txFailures=%ld\r\n", zclDiagnostics_Counters.wakeUps,
+         zclDiagnostics_Counters.framesSent, zclDiagnostics_Counters.txFailures);
+}
+
+void zclDiagnostics_Wake(void) { zclDiagnostics_Counters.wakeUps++; }
+
+void zclDiagnostics_FrameConfirmed(uint8 status) {
+    if (status == ZSuccess) {
+        zclDiagnostics_Counters.framesSent++;
+    } else {
+        zclDiagnostics_Counters.txFailures++;
+    }
+}
+
+void zclDiagnostics_Rejoin(void) { zclDiagnostics_Counters.rejoins++; }
+
+void zclDiagnostics_Reported(void) {
+    if (zclDiagnostics_BootReportMs == 0) {
+        // system clock starts from 0 at reset
+        zclDiagnostics_BootReportMs = osal_GetSystemClock();
+        LREP("Boot to report %ldms\r\n", zclDiagnostics_BootReportMs);
+    }
+}
+
+void zclDiagnostics_SensorError(uint8 sensor, int8 rslt) {
+    switch (sensor) {
+    case DIAGNOSTICS_SENSOR_BME280:
+        zclDiagnostics_Counters.bme280Errors++;
+        zclDiagnostics_Counters.bme280LastError = rslt;
+        break;
+    case DIAGNOSTICS_SENSOR_DS18B20:
+        zclDiagnostics_Counters.ds18b20Errors++;
+        break;
+    default:
+        break;
+    }
+}
+
+void zclDiagnostics_CycleEnd(void) {
+    zclDiagnostics_Counters.awakeMs += zclEnergy_LastCycle.awakeMs;
+    zclDiagnostics_Counters.holdMs += zclEnergy_LastCycle.holdMs;
+    zclDiagnostics_Counters.lastCycleMs = zclEnergy_LastCycle.durationMs;
+    if (++cyclesSinceSave >= DIAGNOSTICS_SAVE_CYCLES) {
+        cyclesSinceSave = 0;
+        osal_nv_write(NW_APP_DIAGNOSTICS, 0, sizeof(zclDiagnostics_Counters), &zclDiagnostics_Counters);
+    }
+}
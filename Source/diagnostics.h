@@ -0,0 +1,76 @@
+#ifndef DIAGNOSTICS_H
+#define DIAGNOSTICS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "hal_types.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// counters are written to NV once per this many report cycles to spare flash
+#ifndef DIAGNOSTICS_SAVE_CYCLES
+#define DIAGNOSTICS_SAVE_CYCLES 8
+#endif
+
+#define DIAGNOSTICS_SENSOR_BME280 0
+#define DIAGNOSTICS_SENSOR_DS18B20 1
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+/**
+ * FYI: persisted in NV as is, changing layout resets counters after firmware update
+ * */
+typedef struct {
+    uint32 wakeUps;     // sensor acquisition wakes
+    uint32 awakeMs;     // cumulative, see zclEnergy_Cycle_t
+    uint32 holdMs;      // cumulative time in PWRMGR_HOLD
+    uint32 framesSent;  // frames confirmed by MAC/APS
+    uint32 txFailures;  // frames not confirmed
+    uint32 lastCycleMs; // duration of last report cycle
+    uint16 rejoins;
+    uint16 bme280Errors;
+    uint16 ds18b20Errors;
+    int8 bme280LastError; // rslt of last failed BME280 call
+} zclDiagnostics_Counters_t;
+
+/*********************************************************************
+ * VARIABLES
+ */
+extern zclDiagnostics_Counters_t zclDiagnostics_Counters;
+extern uint32 zclDiagnostics_BootReportMs; // from reset till first report frame, 0 - not reported yet
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+
+/*
+ * Restores counters from NV
+ */
+extern void zclDiagnostics_Init(void);
+
+extern void zclDiagnostics_Wake(void);
+extern void zclDiagnostics_FrameConfirmed(uint8 status);
+extern void zclDiagnostics_Rejoin(void);
+
+/*
+ * Report frames were sent, first call after reset sets zclDiagnostics_BootReportMs
+ */
+extern void zclDiagnostics_Reported(void);
+extern void zclDiagnostics_SensorError(uint8 sensor, int8 rslt);
+
+/*
+ * Adds zclEnergy_LastCycle to counters and saves them every DIAGNOSTICS_SAVE_CYCLES
+ */
+extern void zclDiagnostics_CycleEnd(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DIAGNOSTICS_H */
@@ -0,0 +1,109 @@
+#include "OSAL.h"
+
+#include "ds18b20_async.h"
+#include "onewire.h"
+#include "sensors.h"
+
+#if APP_SENSOR_DS18B20
+
+/*********************************************************************
+ * CONSTANTS
+ */
+#define DS18B20_CMD_CONVERT_T 0x44
+#define DS18B20_CMD_WRITE_SCRATCHPAD 0x4E
+#define DS18B20_CMD_READ_SCRATCHPAD 0xBE
+
+#define DS18B20_SCRATCHPAD_SIZE 9
+#define DS18B20_CONFIG_RESERVED_BITS 0x1F
+#define DS18B20_ALARM_TH 0x7F
+#define DS18B20_ALARM_TL 0x80
+
+// value of temperature register after power-up, conversion didn't happen
+#define DS18B20_POWER_ON_VALUE 0x0550
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+static const uint16 conversionTimes[DS18B20_RESOLUTION_MAX - DS18B20_RESOLUTION_MIN + 1] = {94, 188, 375, 750};
+static uint8 currentResolution = DS18B20_RESOLUTION_MAX;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static uint8 ds18b20_ClampResolution(uint8 resolution);
+
+static uint8 ds18b20_ClampResolution(uint8 resolution) {
+    if (resolution < DS18B20_RESOLUTION_MIN) {
+        return DS18B20_RESOLUTION_MIN;
+    }
+    if (resolution > DS18B20_RESOLUTION_MAX) {
+        return DS18B20_RESOLUTION_MAX;
+    }
+    return resolution;
+}
+
+uint8 ds18b20_Search(uint8 (*roms)[ONEWIRE_ROM_SIZE], uint8 maxCount) {
+    uint8 found = onewire_Search(roms, maxCount);
+    uint8 count = 0;
+    for (uint8 i = 0; i < found; i++) {
+        if (roms[i][0] != DS18B20_FAMILY_CODE) {
+            continue;
+        }
+        if (count != i) {
+            osal_memcpy(roms[count], roms[i], ONEWIRE_ROM_SIZE);
+        }
+        count++;
+    }
+    return count;
+}
+
+uint16 ds18b20_ConversionTime(uint8 resolution) { return conversionTimes[ds18b20_ClampResolution(resolution) - DS18B20_RESOLUTION_MIN]; }
+
+bool ds18b20_StartConversion(uint8 resolution) {
+    currentResolution = ds18b20_ClampResolution(resolution);
+    /**
+     * FYI: sensor is power cycled every reading, so configuration register
+     * is back to EEPROM value and has to be written before each conversion
+     * */
+    if (!onewire_Select(NULL)) {
+        return FALSE;
+    }
+    onewire_WriteByte(DS18B20_CMD_WRITE_SCRATCHPAD);
+    onewire_WriteByte(DS18B20_ALARM_TH);
+    onewire_WriteByte(DS18B20_ALARM_TL);
+    onewire_WriteByte(((currentResolution - DS18B20_RESOLUTION_MIN) << 5) | DS18B20_CONFIG_RESERVED_BITS);
+
+    // all probes convert in parallel, so the wait doesn't grow with their number
+    if (!onewire_Select(NULL)) {
+        return FALSE;
+    }
+    onewire_WriteByte(DS18B20_CMD_CONVERT_T);
+    return TRUE;
+}
+
+bool ds18b20_ReadTemperature(const uint8 *rom, int16 *temperature) {
+    uint8 scratchpad[DS18B20_SCRATCHPAD_SIZE];
+
+    if (!onewire_Select(rom)) {
+        return FALSE;
+    }
+    onewire_WriteByte(DS18B20_CMD_READ_SCRATCHPAD);
+    for (uint8 i = 0; i < DS18B20_SCRATCHPAD_SIZE; i++) {
+        scratchpad[i] = onewire_ReadByte();
+    }
+    if (onewire_Crc8(scratchpad, DS18B20_SCRATCHPAD_SIZE - 1) != scratchpad[DS18B20_SCRATCHPAD_SIZE - 1]) {
+        return FALSE;
+    }
+
+    int16 raw = (int16)((uint16)scratchpad[1] << 8 | scratchpad[0]);
+    if (raw == DS18B20_POWER_ON_VALUE) {
+        return FALSE;
+    }
+    // undefined low bits for resolutions below 12 bit
+    raw &= ~((1 << (DS18B20_RESOLUTION_MAX - currentResolution)) - 1);
+    // 1/16 C to 0.01 C
+    *temperature = (int16)((int32)raw * 25 / 4);
+    return TRUE;
+}
+
+#endif
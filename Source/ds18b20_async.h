@@ -0,0 +1,50 @@
+#ifndef DS18B20_ASYNC_H
+#define DS18B20_ASYNC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "hal_types.h"
+#include "onewire.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+#define DS18B20_RESOLUTION_MIN 9
+#define DS18B20_RESOLUTION_MAX 12
+
+#define DS18B20_FAMILY_CODE 0x28
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+
+/*
+ * Finds DS18B20 probes on the bus, other 1-wire devices are skipped.
+ * Returns number of ROMs written to roms
+ */
+extern uint8 ds18b20_Search(uint8 (*roms)[ONEWIRE_ROM_SIZE], uint8 maxCount);
+
+/*
+ * Configures resolution and starts temperature conversion on all probes at once with Skip ROM,
+ * doesn't wait for result. Returns FALSE if no sensor responded
+ */
+extern bool ds18b20_StartConversion(uint8 resolution);
+
+/*
+ * Maximum conversion time in ms for given resolution
+ */
+extern uint16 ds18b20_ConversionTime(uint8 resolution);
+
+/*
+ * Reads scratchpad of probe with given ROM after conversion, temperature is in 0.01 C.
+ * NULL rom addresses the only probe on the bus. Returns FALSE on bus or CRC error
+ */
+extern bool ds18b20_ReadTemperature(const uint8 *rom, int16 *temperature);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DS18B20_ASYNC_H */
@@ -0,0 +1,185 @@
+#include "OSAL.h"
+#include "hal_mcu.h"
+
+#include "Debug.h"
+#include "energy.h"
+#include "trace.h"
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+zclEnergy_Cycle_t zclEnergy_LastCycle = {0, 0, 0, 0, 0, 0, 0};
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+static zclEnergy_Cycle_t currentCycle;
+
+static bool inCycle = FALSE;
+static bool inActivity = FALSE;
+static bool inHold = FALSE;
+static bool sensorsOn = FALSE;
+static bool excitationOn = FALSE;
+
+static uint32 cycleStartTicks = 0;
+static uint32 holdStartTicks = 0;
+static uint32 sensorsOnTicks = 0;
+static uint32 excitationTicks = 0;
+static uint32 activityTicks = 0; // start of awake interval, not used while in hold
+// handlers are often shorter than 1 ms, so intervals are summed in ticks and converted once
+static uint32 awakeTicks = 0;
+static uint32 holdTicks = 0;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static void zclEnergy_CloseAwake(uint32 now);
+
+uint32 zclEnergy_Ticks(void) {
+    uint32 ticks;
+    // FYI: ST0 should be read first, it latches ST1 and ST2
+    ticks = ST0;
+    ticks |= ((uint32)ST1 << 8);
+    ticks |= ((uint32)ST2 << 16);
+    return ticks;
+}
+
+uint32 zclEnergy_TicksToMs(uint32 ticks) {
+    // ticks * 1000 / 32768 without overflowing 24 bit input
+    return (ticks * 125) >> 12;
+}
+
+void zclEnergy_CycleStart(void) {
+    osal_memset(&currentCycle, 0, sizeof(currentCycle));
+    awakeTicks = 0;
+    holdTicks = 0;
+    cycleStartTicks = zclEnergy_Ticks();
+    inCycle = TRUE;
+    zclTrace_Record(TRACE_CYCLE_START, 0);
+    if (inActivity) {
+        // handler which started cycle was running before it, that part belongs to no cycle
+        activityTicks = cycleStartTicks;
+    }
+    if (inHold) {
+        holdStartTicks = cycleStartTicks;
+    }
+    if (sensorsOn) {
+        sensorsOnTicks = cycleStartTicks;
+    }
+    if (excitationOn) {
+        excitationTicks = cycleStartTicks;
+    }
+}
+
+void zclEnergy_CycleEnd(void) {
+    if (!inCycle) {
+        return;
+    }
+    uint32 now = zclEnergy_Ticks();
+    zclEnergy_CloseAwake(now);
+    if (inHold) {
+        holdTicks += ENERGY_TICKS_DIFF(now, holdStartTicks);
+        holdStartTicks = now;
+    }
+    if (sensorsOn) {
+        currentCycle.sensorsOnMs += zclEnergy_TicksToMs(ENERGY_TICKS_DIFF(now, sensorsOnTicks));
+        sensorsOnTicks = now;
+    }
+    if (excitationOn) {
+        currentCycle.excitationMs += zclEnergy_TicksToMs(ENERGY_TICKS_DIFF(now, excitationTicks));
+        excitationTicks = now;
+    }
+    currentCycle.durationMs = zclEnergy_TicksToMs(ENERGY_TICKS_DIFF(now, cycleStartTicks));
+    currentCycle.holdMs = zclEnergy_TicksToMs(holdTicks);
+    currentCycle.awakeMs = zclEnergy_TicksToMs(awakeTicks + holdTicks);
+    if (currentCycle.awakeMs > currentCycle.durationMs) {
+        currentCycle.awakeMs = currentCycle.durationMs;
+    }
+
+    uint32 chargeUAms = currentCycle.awakeMs * ENERGY_ACTIVE_UA;
+    chargeUAms += currentCycle.sensorsOnMs * ENERGY_SENSORS_UA;
+    chargeUAms += currentCycle.excitationMs * ENERGY_EXCITATION_UA;
+    chargeUAms += (currentCycle.durationMs - currentCycle.awakeMs) * ENERGY_SLEEP_UA;
+    currentCycle.energyUAs = chargeUAms / 1000 + (uint32)currentCycle.reports * ENERGY_TX_UAS;
+
+    zclEnergy_LastCycle = currentCycle;
+    inCycle = FALSE;
+    zclTrace_Record(TRACE_CYCLE_END, 0);
+
+    LREP("Energy cycle=%ldms awake=%ldms hold=%ldms sensors=%ldms excitation=%ldms reports=%d energy=%lduAs\r\n",
+         zclEnergy_LastCycle.durationMs, zclEnergy_LastCycle.awakeMs, zclEnergy_LastCycle.holdMs, zclEnergy_LastCycle.sensorsOnMs,
+         zclEnergy_LastCycle.excitationMs, zclEnergy_LastCycle.reports, zclEnergy_LastCycle.energyUAs);
+}
+
+/**
+ * FYI: awake and hold intervals never overlap, hold closes awake interval of running handler
+ * and reopens it when released, hold is added to awake time only once in zclEnergy_CycleEnd
+ * */
+static void zclEnergy_CloseAwake(uint32 now) {
+    if (inCycle && inActivity && !inHold) {
+        awakeTicks += ENERGY_TICKS_DIFF(now, activityTicks);
+    }
+    activityTicks = now;
+}
+
+void zclEnergy_ActivityBegin(void) {
+    activityTicks = zclEnergy_Ticks();
+    inActivity = TRUE;
+}
+
+void zclEnergy_ActivityEnd(void) {
+    zclEnergy_CloseAwake(zclEnergy_Ticks());
+    inActivity = FALSE;
+}
+
+void zclEnergy_Hold(bool hold) {
+    if (hold == inHold) {
+        return;
+    }
+    uint32 now = zclEnergy_Ticks();
+    if (hold) {
+        zclEnergy_CloseAwake(now);
+        holdStartTicks = now;
+    } else {
+        if (inCycle) {
+            holdTicks += ENERGY_TICKS_DIFF(now, holdStartTicks);
+        }
+        activityTicks = now;
+    }
+    inHold = hold;
+    zclTrace_Record(TRACE_HOLD, hold);
+}
+
+void zclEnergy_SensorsPower(bool on) {
+    if (on == sensorsOn) {
+        return;
+    }
+    uint32 now = zclEnergy_Ticks();
+    if (on) {
+        sensorsOnTicks = now;
+    } else if (inCycle) {
+        currentCycle.sensorsOnMs += zclEnergy_TicksToMs(ENERGY_TICKS_DIFF(now, sensorsOnTicks));
+    }
+    sensorsOn = on;
+    zclTrace_Record(TRACE_SENSORS_POWER, on);
+}
+
+void zclEnergy_Excitation(bool on) {
+    if (on == excitationOn) {
+        return;
+    }
+    uint32 now = zclEnergy_Ticks();
+    if (on) {
+        excitationTicks = now;
+    } else if (inCycle) {
+        currentCycle.excitationMs += zclEnergy_TicksToMs(ENERGY_TICKS_DIFF(now, excitationTicks));
+    }
+    excitationOn = on;
+    zclTrace_Record(TRACE_EXCITATION, on);
+}
+
+void zclEnergy_CountReport(void) {
+    if (inCycle) {
+        currentCycle.reports++;
+    }
+}
@@ -0,0 +1,85 @@
+#ifndef ENERGY_H
+#define ENERGY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "hal_types.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+/**
+ * FYI: rough supply currents used to estimate energy per report cycle,
+ * values are from CC2530 datasheet, override them in preinclude.h for a specific board
+ * */
+#ifndef ENERGY_ACTIVE_UA
+#define ENERGY_ACTIVE_UA 6500 // MCU active, radio off
+#endif
+
+#ifndef ENERGY_SENSORS_UA
+#define ENERGY_SENSORS_UA 500 // sensors power rail
+#endif
+
+#ifndef ENERGY_EXCITATION_UA
+#define ENERGY_EXCITATION_UA 1000 // soil probe PWM excitation and timer 3
+#endif
+
+#ifndef ENERGY_SLEEP_UA
+#define ENERGY_SLEEP_UA 2 // PM2 with sleep timer running
+#endif
+
+#ifndef ENERGY_TX_UAS
+#define ENERGY_TX_UAS 150 // single frame incl. CCA and MAC ack wait, uA*s
+#endif
+
+/*********************************************************************
+ * MACROS
+ */
+
+// sleep timer is 24 bit wide and runs from 32.768 kHz clock
+#define ENERGY_TICKS_MASK 0x00FFFFFF
+#define ENERGY_TICKS_DIFF(now, start) (((now) - (start)) & ENERGY_TICKS_MASK)
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+typedef struct {
+    uint32 durationMs;   // from first phase till sensors power off
+    uint32 awakeMs;      // MCU not allowed to sleep or busy in handlers
+    uint32 holdMs;       // time in PWRMGR_HOLD
+    uint32 sensorsOnMs;  // sensors power rail enabled
+    uint32 excitationMs; // soil probe excited
+    uint16 reports;      // report frames sent during cycle
+    uint32 energyUAs;    // estimated charge, uA*s
+} zclEnergy_Cycle_t;
+
+/*********************************************************************
+ * VARIABLES
+ */
+extern zclEnergy_Cycle_t zclEnergy_LastCycle;
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+extern void zclEnergy_CycleStart(void);
+extern void zclEnergy_CycleEnd(void);
+
+extern void zclEnergy_ActivityBegin(void);
+extern void zclEnergy_ActivityEnd(void);
+
+extern void zclEnergy_Hold(bool hold);
+extern void zclEnergy_SensorsPower(bool on);
+extern void zclEnergy_Excitation(bool on);
+extern void zclEnergy_CountReport(void);
+
+extern uint32 zclEnergy_Ticks(void);
+extern uint32 zclEnergy_TicksToMs(uint32 ticks);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ENERGY_H */
@@ -90,10 +90,19 @@
 #define HAL_FLASH_IMPLICIT_CERT_OSET       0x78C
 
 #define HAL_NV_PAGE_BEG           (HAL_NV_PAGE_END-HAL_NV_PAGE_CNT+1)
+
+// Sample history ring buffer right below OSAL NV pages, reserved from code by HISTORY_ADDRESS_SPACE of CC2530DB/flower.xcl.
+// History is disabled at runtime if these pages contain anything but history records.
+#ifndef HAL_HISTORY_PAGE_CNT
+#define HAL_HISTORY_PAGE_CNT       4
+#endif
+#define HAL_HISTORY_PAGE_END      (HAL_NV_PAGE_BEG-1)
+#define HAL_HISTORY_PAGE_BEG      (HAL_HISTORY_PAGE_END-HAL_HISTORY_PAGE_CNT+1)
 // Used by DMA macros to shift 1 to create a mask for DMA registers.
 #define HAL_NV_DMA_CH              0
 #define HAL_DMA_CH_RX              3
 #define HAL_DMA_CH_TX              4
+#define HAL_DMA_CH_ADC             1
 
 #define HAL_NV_DMA_GET_DESC()      HAL_DMA_GET_DESC0()
 #define HAL_NV_DMA_SET_ADDR(a)     HAL_DMA_SET_ADDR_DESC0((a))
@@ -179,7 +188,8 @@ extern void MAC_RfFrontendSetup(void);
   #define LED1_POLARITY     ACTIVE_LOW
 #endif
 
-//power pin
+//power pin, keep it on in sleep while halPowerPinLatched is set
+extern uint8 halPowerPinLatched;
 #define LED4_BV           BV(1)
 #define LED4_SBIT         P1_1
 #define LED4_DDR          P1DIR
@@ -188,7 +198,7 @@ extern void MAC_RfFrontendSetup(void);
 #define HAL_TURN_OFF_LED1()       st( LED1_SBIT = LED1_POLARITY (0); )
 #define HAL_TURN_OFF_LED2()       asm("NOP")
 #define HAL_TURN_OFF_LED3()       asm("NOP")
-#define HAL_TURN_OFF_LED4()       st( LED4_SBIT = LED4_POLARITY (0); )
+#define HAL_TURN_OFF_LED4()       st( if (!halPowerPinLatched) { LED4_SBIT = LED4_POLARITY (0); } )
 
 #define HAL_TURN_ON_LED1()        st( LED1_SBIT = LED1_POLARITY (1); )
 #define HAL_TURN_ON_LED2()        asm("NOP")
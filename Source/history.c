@@ -0,0 +1,282 @@
+#include "AF.h"
+#include "OSAL.h"
+#include "OSAL_Clock.h"
+#include "OSAL_Nv.h"
+#include "zcl.h"
+
+#include "bdb.h"
+#include "bdb_interface.h"
+
+#include "hal_adc.h"
+#include "hal_flash.h"
+
+#include "Debug.h"
+#include "energy.h"
+#include "history.h"
+#include "zcl_app.h"
+
+/*********************************************************************
+ * MACROS
+ */
+#define HISTORY_HEADER_SIZE sizeof(zclHistory_PageHeader_t)
+#define HISTORY_RECORD_SIZE sizeof(zclHistory_Record_t)
+#define HISTORY_RECORD_WORDS (HISTORY_RECORD_SIZE / HAL_FLASH_WORD_SIZE)
+#define HISTORY_RECORDS_PER_PAGE ((HAL_FLASH_PAGE_SIZE - HISTORY_HEADER_SIZE) / HISTORY_RECORD_SIZE)
+
+// sequence number of record maps to fixed page and position, page header holds sequence of its first record
+#define HISTORY_PAGE(seq) ((uint8)(HAL_HISTORY_PAGE_BEG + ((seq) / HISTORY_RECORDS_PER_PAGE) % HAL_HISTORY_PAGE_CNT))
+#define HISTORY_INDEX(seq) ((uint16)((seq) % HISTORY_RECORDS_PER_PAGE))
+#define HISTORY_OFFSET(index) ((uint16)(HISTORY_HEADER_SIZE + (index)*HISTORY_RECORD_SIZE))
+#define HISTORY_WORD_ADDR(page, offset) ((uint16)(((uint32)(page)*HAL_FLASH_PAGE_SIZE + (offset)) / HAL_FLASH_WORD_SIZE))
+
+#define HISTORY_ERASED_WORD 0xFFFFFFFFUL
+
+// HISTORY_ADDRESS_SPACE range of CC2530DB/flower.xcl, linker file can't include hal_board_cfg.h, so pages are compared here
+#define HISTORY_XCL_PAGE_BEG 117
+#define HISTORY_XCL_PAGE_CNT 4
+#if !defined NON_BANKED && (HAL_HISTORY_PAGE_BEG != HISTORY_XCL_PAGE_BEG || HAL_HISTORY_PAGE_CNT != HISTORY_XCL_PAGE_CNT)
+#error "History pages moved, update HISTORY_ADDRESS_SPACE in CC2530DB/flower.xcl and HISTORY_XCL_* here"
+#endif
+
+// current clock (uint32) + records count (uint8)
+#define HISTORY_FRAME_HEADER_SIZE 5
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+typedef struct {
+    uint32 magic;
+    uint32 firstSeq;
+} zclHistory_PageHeader_t;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+static bool historyEnabled = FALSE;
+static uint32 firstSeq = 0;   // oldest record found in flash
+static uint32 writeSeq = 0;   // next record written to flash gets this number
+static uint32 drainedSeq = 0; // records before it were delivered, persisted in NV
+static uint32 drainSeq = 0;   // cursor of current drain session
+static bool draining = FALSE;
+
+static zclHistory_Record_t batch[HISTORY_BATCH_SIZE];
+static uint8 batchCount = 0;
+
+static afAddrType_t historyDstAddr = {.addrMode = (afAddrMode_t)Addr16Bit, .endPoint = 1, .addr.shortAddr = 0x0000};
+
+#ifdef __IAR_SYSTEMS_ICC__
+/**
+ * FYI: same way OSAL_Nv reserves ZIGNV_ADDRESS_SPACE, linker allocates history pages before banked code,
+ * so image which reaches them fails to link instead of being overwritten by first record
+ * */
+#pragma location = "HISTORY_ADDRESS_SPACE"
+__no_init uint8 _historyBuf[HAL_HISTORY_PAGE_CNT * HAL_FLASH_PAGE_SIZE];
+#pragma required = _historyBuf
+#endif
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static bool zclHistory_PageErased(uint8 page);
+static void zclHistory_PreparePage(uint8 page, uint32 seq);
+static void zclHistory_Sync(void);
+static uint32 zclHistory_OldestSeq(void);
+
+void zclHistory_Init(void) {
+    zclHistory_PageHeader_t header;
+    bool found = FALSE;
+    uint32 newestSeq = 0;
+
+    if (osal_nv_item_init(NW_APP_HISTORY, sizeof(drainedSeq), &drainedSeq) == SUCCESS) {
+        osal_nv_read(NW_APP_HISTORY, 0, sizeof(drainedSeq), &drainedSeq);
+    }
+
+    for (uint8 page = HAL_HISTORY_PAGE_BEG; page <= HAL_HISTORY_PAGE_END; page++) {
+        HalFlashRead(page, 0, (uint8 *)&header, sizeof(header));
+        if (header.magic != HISTORY_MAGIC) {
+            if (!zclHistory_PageErased(page)) {
+                LREP("History page %d is not empty, history disabled\r\n", page);
+                return;
+            }
+            continue;
+        }
+        if (HISTORY_PAGE(header.firstSeq) != page || HISTORY_INDEX(header.firstSeq) != 0) {
+            // left from build with different page count
+            HalFlashErase(page);
+            continue;
+        }
+        if (!found || header.firstSeq < firstSeq) {
+            firstSeq = header.firstSeq;
+        }
+        if (!found || header.firstSeq > newestSeq) {
+            newestSeq = header.firstSeq;
+        }
+        found = TRUE;
+    }
+
+    if (found) {
+        uint16 index = 0;
+        uint32 timestamp;
+        uint8 page = HISTORY_PAGE(newestSeq);
+        while (index < HISTORY_RECORDS_PER_PAGE) {
+            HalFlashRead(page, HISTORY_OFFSET(index), (uint8 *)&timestamp, sizeof(timestamp));
+            if (timestamp == HISTORY_ERASED_WORD) {
+                break;
+            }
+            index++;
+        }
+        writeSeq = newestSeq + index;
+        if (drainedSeq > writeSeq) {
+            drainedSeq = writeSeq;
+        }
+    } else {
+        // nothing in flash, continue numbering from drain cursor aligned to page start
+        writeSeq = drainedSeq;
+        if (HISTORY_INDEX(writeSeq) != 0) {
+            writeSeq += HISTORY_RECORDS_PER_PAGE - HISTORY_INDEX(writeSeq);
+        }
+        firstSeq = writeSeq;
+        drainedSeq = writeSeq;
+    }
+    historyEnabled = TRUE;
+    LREP("History first=%ld write=%ld drained=%ld\r\n", firstSeq, writeSeq, drainedSeq);
+}
+
+void zclHistory_Store(const zclHistory_Record_t *record) {
+    if (!historyEnabled) {
+        return;
+    }
+    if (batchCount == HISTORY_BATCH_SIZE) {
+        // previous flash write was postponed because of low voltage
+        LREPMaster("History batch is full, dropping record\r\n");
+        return;
+    }
+    batch[batchCount] = *record;
+    batch[batchCount].sequence = (uint16)(writeSeq + batchCount);
+    batchCount++;
+    if (batchCount == HISTORY_BATCH_SIZE) {
+        zclHistory_Sync();
+    }
+}
+
+uint16 zclHistory_Pending(void) {
+    if (!historyEnabled) {
+        return 0;
+    }
+    return (uint16)(writeSeq - MAX(drainedSeq, zclHistory_OldestSeq())) + batchCount;
+}
+
+bool zclHistory_IsDraining(void) { return draining; }
+
+bool zclHistory_SendNext(uint8 endpoint) {
+    if (!historyEnabled) {
+        return FALSE;
+    }
+    if (!draining) {
+        zclHistory_Sync();
+        drainSeq = drainedSeq;
+        draining = TRUE;
+    }
+    // records could be overwritten while draining
+    drainSeq = MAX(drainSeq, zclHistory_OldestSeq());
+
+    uint8 count = (uint8)MIN(writeSeq - drainSeq, HISTORY_RECORDS_PER_FRAME);
+    if (count == 0) {
+        draining = FALSE;
+        drainedSeq = drainSeq;
+        osal_nv_write(NW_APP_HISTORY, 0, sizeof(drainedSeq), &drainedSeq);
+        LREP("History drained till %ld\r\n", drainedSeq);
+        return FALSE;
+    }
+
+    uint8 len = HISTORY_FRAME_HEADER_SIZE + count * HISTORY_RECORD_SIZE;
+    uint8 *frame = osal_mem_alloc(len);
+    if (frame == NULL) {
+        LREPMaster("History no memory\r\n");
+        zclHistory_Abort();
+        return FALSE;
+    }
+    uint8 *pBuf = osal_buffer_uint32(frame, osal_getClock());
+    *pBuf++ = count;
+    for (uint8 i = 0; i < count; i++) {
+        uint32 seq = drainSeq + i;
+        HalFlashRead(HISTORY_PAGE(seq), HISTORY_OFFSET(HISTORY_INDEX(seq)), pBuf, HISTORY_RECORD_SIZE);
+        pBuf += HISTORY_RECORD_SIZE;
+    }
+
+    ZStatus_t status = zcl_SendCommand(endpoint, &historyDstAddr, FLOWER_CTRL, COMMAND_FLOWER_CTRL_HISTORY, TRUE,
+                                       ZCL_FRAME_SERVER_CLIENT_DIR, TRUE, 0, bdb_getZCLFrameCounter(), len, frame);
+    osal_mem_free(frame);
+    if (status != ZSuccess) {
+        zclHistory_Abort();
+        return FALSE;
+    }
+    zclEnergy_CountReport();
+    drainSeq += count;
+    return TRUE;
+}
+
+void zclHistory_Abort(void) {
+    if (draining) {
+        LREP("History drain aborted at %ld, restart from %ld\r\n", drainSeq, drainedSeq);
+        draining = FALSE;
+    }
+}
+
+static uint32 zclHistory_OldestSeq(void) {
+    if (writeSeq == 0) {
+        return firstSeq;
+    }
+    // all pages except one with last written record could be overwritten already
+    uint32 lastPageStart = (writeSeq - 1) - HISTORY_INDEX(writeSeq - 1);
+    uint32 keptSpan = (uint32)(HAL_HISTORY_PAGE_CNT - 1) * HISTORY_RECORDS_PER_PAGE;
+    if (lastPageStart < keptSpan) {
+        return firstSeq;
+    }
+    return MAX(firstSeq, lastPageStart - keptSpan);
+}
+
+static void zclHistory_Sync(void) {
+    uint8 i = 0;
+    if (batchCount == 0) {
+        return;
+    }
+    if (!HalAdcCheckVdd(VDD_MIN_NV)) {
+        LREPMaster("History low voltage, flash write postponed\r\n");
+        return;
+    }
+    /**
+     * FYI: page is erased only when first record goes into it,
+     * so there is one erase per HISTORY_RECORDS_PER_PAGE records
+     * */
+    while (i < batchCount) {
+        uint8 page = HISTORY_PAGE(writeSeq);
+        uint16 index = HISTORY_INDEX(writeSeq);
+        if (index == 0) {
+            zclHistory_PreparePage(page, writeSeq);
+        }
+        uint8 run = (uint8)MIN(batchCount - i, HISTORY_RECORDS_PER_PAGE - index);
+        HalFlashWrite(HISTORY_WORD_ADDR(page, HISTORY_OFFSET(index)), (uint8 *)&batch[i], run * HISTORY_RECORD_WORDS);
+        writeSeq += run;
+        i += run;
+    }
+    LREP("History wrote %d records, next %ld\r\n", batchCount, writeSeq);
+    batchCount = 0;
+}
+
+static void zclHistory_PreparePage(uint8 page, uint32 seq) {
+    zclHistory_PageHeader_t header = {HISTORY_MAGIC, seq};
+    HalFlashErase(page);
+    HalFlashWrite(HISTORY_WORD_ADDR(page, 0), (uint8 *)&header, sizeof(header) / HAL_FLASH_WORD_SIZE);
+}
+
+static bool zclHistory_PageErased(uint8 page) {
+    uint32 word;
+    for (uint16 offset = 0; offset < HAL_FLASH_PAGE_SIZE; offset += sizeof(word)) {
+        HalFlashRead(page, offset, (uint8 *)&word, sizeof(word));
+        if (word != HISTORY_ERASED_WORD) {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
@@ -0,0 +1,82 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "hal_types.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+#define HISTORY_MAGIC 0x53494846UL // "FHIS"
+
+// records kept in RAM before they are written to flash
+#ifndef HISTORY_BATCH_SIZE
+#define HISTORY_BATCH_SIZE 4
+#endif
+
+// keep single frame below APS payload limit for secured unfragmented frames
+#ifndef HISTORY_RECORDS_PER_FRAME
+#define HISTORY_RECORDS_PER_FRAME 3
+#endif
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+/**
+ * FYI: record size should be multiple of HAL_FLASH_WORD_SIZE,
+ * it's sent over the air as is, so all fields are little endian
+ * */
+typedef struct {
+    uint32 timestamp; // osal_getClock() seconds
+    int16 temperature;
+    uint16 humidity;
+    int16 pressure;
+    uint16 illuminance;
+    uint16 soilHumidity;
+    int16 ds18b20Temperature;
+    uint8 batteryVoltage;
+    uint8 reserved;
+    uint16 sequence; // lower bits of record number, lets backend drop duplicates of aborted drains
+} zclHistory_Record_t;
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+
+/*
+ * Scans history pages and restores write position and drain cursor
+ */
+extern void zclHistory_Init(void);
+
+/*
+ * Appends record, records are written to flash in batches of HISTORY_BATCH_SIZE
+ */
+extern void zclHistory_Store(const zclHistory_Record_t *record);
+
+/*
+ * Number of records not drained yet
+ */
+extern uint16 zclHistory_Pending(void);
+
+/*
+ * Sends next frame of records from endpoint to coordinator,
+ * returns FALSE when nothing left to send or sending failed
+ */
+extern bool zclHistory_SendNext(uint8 endpoint);
+
+/*
+ * Drain session failed (e.g. frame wasn't delivered), next drain starts from last completed one
+ */
+extern void zclHistory_Abort(void);
+
+extern bool zclHistory_IsDraining(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HISTORY_H */
@@ -0,0 +1,172 @@
+#include "OnBoard.h"
+#include "hal_mcu.h"
+
+#include "i2c_fast.h"
+#include "sensors.h"
+
+#if APP_SENSOR_BME280
+
+/*********************************************************************
+ * MACROS
+ */
+
+// lines are open drain, 0 is latched once, pin is pulled low as output and released to pull-up as input
+#define I2C_FAST_SCL_LOW() st(OCM_CLK_DIR |= BV(OCM_CLK_PIN);)
+#define I2C_FAST_SCL_RELEASE() st(OCM_CLK_DIR &= ~BV(OCM_CLK_PIN);)
+#define I2C_FAST_SDA_LOW() st(OCM_DATA_DIR |= BV(OCM_DATA_PIN);)
+#define I2C_FAST_SDA_RELEASE() st(OCM_DATA_DIR &= ~BV(OCM_DATA_PIN);)
+#define I2C_FAST_SCL_READ() (OCM_CLK_SBIT)
+#define I2C_FAST_SDA_READ() (OCM_DATA_SBIT)
+
+#define I2C_FAST_WAIT(loops)                                                                                                               \
+    do {                                                                                                                                   \
+        for (uint8 n = (loops); n > 0; n--) {                                                                                              \
+            ASM_NOP;                                                                                                                       \
+        }                                                                                                                                  \
+    } while (0)
+
+/*********************************************************************
+ * CONSTANTS
+ */
+#define I2C_FAST_READ_BIT 0x01
+// SCL release loops, slow rise on weak pull-ups or clock stretching, transfer goes on after them anyway
+#define I2C_FAST_RISE_LOOPS 200
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+static uint8 transactions = 0; // since last i2cFast_TakeTransactions
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static void i2cFast_SclHigh(void);
+static void i2cFast_Count(void);
+static void i2cFast_Start(void);
+static void i2cFast_Stop(void);
+static bool i2cFast_WriteByte(uint8 data);
+static uint8 i2cFast_ReadByte(bool ack);
+
+void i2cFast_Init(void) {
+    OCM_CLK_SEL &= ~BV(OCM_CLK_PIN);
+    OCM_DATA_SEL &= ~BV(OCM_DATA_PIN);
+    I2C_FAST_SCL_RELEASE();
+    I2C_FAST_SDA_RELEASE();
+    OCM_CLK_SBIT = 0;
+    OCM_DATA_SBIT = 0;
+}
+
+uint8 i2cFast_TakeTransactions(void) {
+    uint8 taken = transactions;
+    transactions = 0;
+    return taken;
+}
+
+static void i2cFast_Count(void) {
+    if (transactions < 0xFF) {
+        transactions++;
+    }
+}
+
+static void i2cFast_SclHigh(void) {
+    uint8 guard = I2C_FAST_RISE_LOOPS;
+    I2C_FAST_SCL_RELEASE();
+    while (!I2C_FAST_SCL_READ() && --guard) {
+    }
+    I2C_FAST_WAIT(I2C_FAST_HIGH_LOOPS);
+}
+
+// also a repeated start, SCL is low then
+static void i2cFast_Start(void) {
+    I2C_FAST_SDA_RELEASE();
+    I2C_FAST_WAIT(I2C_FAST_LOW_LOOPS);
+    i2cFast_SclHigh();
+    I2C_FAST_SDA_LOW();
+    I2C_FAST_WAIT(I2C_FAST_HIGH_LOOPS);
+    I2C_FAST_SCL_LOW();
+}
+
+static void i2cFast_Stop(void) {
+    I2C_FAST_SDA_LOW();
+    I2C_FAST_WAIT(I2C_FAST_LOW_LOOPS);
+    i2cFast_SclHigh();
+    I2C_FAST_SDA_RELEASE();
+    I2C_FAST_WAIT(I2C_FAST_LOW_LOOPS);
+}
+
+static bool i2cFast_WriteByte(uint8 data) {
+    bool ack;
+    for (uint8 i = 0; i < 8; i++) {
+        if (data & 0x80) {
+            I2C_FAST_SDA_RELEASE();
+        } else {
+            I2C_FAST_SDA_LOW();
+        }
+        data <<= 1;
+        I2C_FAST_WAIT(I2C_FAST_LOW_LOOPS);
+        i2cFast_SclHigh();
+        I2C_FAST_SCL_LOW();
+    }
+    I2C_FAST_SDA_RELEASE();
+    I2C_FAST_WAIT(I2C_FAST_LOW_LOOPS);
+    i2cFast_SclHigh();
+    ack = !I2C_FAST_SDA_READ();
+    I2C_FAST_SCL_LOW();
+    return ack;
+}
+
+static uint8 i2cFast_ReadByte(bool ack) {
+    uint8 data = 0;
+    I2C_FAST_SDA_RELEASE();
+    for (uint8 i = 0; i < 8; i++) {
+        I2C_FAST_WAIT(I2C_FAST_LOW_LOOPS);
+        i2cFast_SclHigh();
+        data = (data << 1) | (I2C_FAST_SDA_READ() ? 1 : 0);
+        I2C_FAST_SCL_LOW();
+    }
+    if (ack) {
+        I2C_FAST_SDA_LOW();
+    }
+    I2C_FAST_WAIT(I2C_FAST_LOW_LOOPS);
+    i2cFast_SclHigh();
+    I2C_FAST_SCL_LOW();
+    I2C_FAST_SDA_RELEASE();
+    return data;
+}
+
+int8 i2cFast_Read(uint8 devId, uint8 reg, uint8 *data, uint16 len) {
+    int8 rslt = I2C_FAST_NACK;
+    i2cFast_Count();
+    i2cFast_Start();
+    if (i2cFast_WriteByte(devId << 1) && i2cFast_WriteByte(reg)) {
+        i2cFast_Start();
+        if (i2cFast_WriteByte((devId << 1) | I2C_FAST_READ_BIT)) {
+            // burst, device increments register address itself, last byte is NACKed
+            for (uint16 i = 0; i < len; i++) {
+                data[i] = i2cFast_ReadByte(i + 1 < len);
+            }
+            rslt = I2C_FAST_OK;
+        }
+    }
+    i2cFast_Stop();
+    return rslt;
+}
+
+int8 i2cFast_Write(uint8 devId, uint8 reg, uint8 *data, uint16 len) {
+    int8 rslt = I2C_FAST_NACK;
+    i2cFast_Count();
+    i2cFast_Start();
+    if (i2cFast_WriteByte(devId << 1) && i2cFast_WriteByte(reg)) {
+        rslt = I2C_FAST_OK;
+        for (uint16 i = 0; i < len; i++) {
+            if (!i2cFast_WriteByte(data[i])) {
+                rslt = I2C_FAST_NACK;
+                break;
+            }
+        }
+    }
+    i2cFast_Stop();
+    return rslt;
+}
+
+#endif
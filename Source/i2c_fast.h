@@ -0,0 +1,56 @@
+#ifndef I2C_FAST_H
+#define I2C_FAST_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "hal_types.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+/**
+ * FYI: delay loops of ~6 cycles at 32 MHz, together with pin access they give tLOW 1.3us and tHIGH 0.6us of fast mode.
+ * Fast mode needs external pull-ups, with internal ~20k only rise times are longer, SCL release waits for them
+ * */
+#ifndef I2C_FAST_LOW_LOOPS
+#define I2C_FAST_LOW_LOOPS 7
+#endif
+#ifndef I2C_FAST_HIGH_LOOPS
+#define I2C_FAST_HIGH_LOOPS 3
+#endif
+
+#define I2C_FAST_OK 0
+#define I2C_FAST_NACK -1
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+
+/*
+ * Switches OCM_CLK/OCM_DATA pins to GPIO and releases them, pull-ups are set by zclApp with sensors power
+ */
+extern void i2cFast_Init(void);
+
+/*
+ * Writes reg address and reads len bytes in a single burst after repeated start, same signature as bme280_com_fptr_t
+ */
+extern int8 i2cFast_Read(uint8 devId, uint8 reg, uint8 *data, uint16 len);
+
+/*
+ * Writes reg address followed by len bytes of data, same signature as bme280_com_fptr_t
+ */
+extern int8 i2cFast_Write(uint8 devId, uint8 reg, uint8 *data, uint16 len);
+
+/*
+ * Returns number of bus transactions since previous call and resets it, saturates to 255
+ */
+extern uint8 i2cFast_TakeTransactions(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* I2C_FAST_H */
@@ -0,0 +1,187 @@
+#include "OSAL.h"
+#include "OnBoard.h"
+#include "hal_mcu.h"
+
+#include "onewire.h"
+#include "sensors.h"
+
+#if APP_SENSOR_DS18B20
+
+/*********************************************************************
+ * MACROS
+ */
+
+// pin is released to pull-up when configured as input
+#define ONEWIRE_LOW()                                                                                                                      \
+    do {                                                                                                                                   \
+        TSENS_SBIT = 0;                                                                                                                    \
+        TSENS_DIR |= TSENS_BV;                                                                                                             \
+    } while (0)
+#define ONEWIRE_RELEASE() st(TSENS_DIR &= ~TSENS_BV;)
+#define ONEWIRE_READ() (TSENS_SBIT)
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// standard speed timings, us
+#define ONEWIRE_RESET_LOW 480
+#define ONEWIRE_PRESENCE_WAIT 70
+#define ONEWIRE_PRESENCE_TAIL 410
+#define ONEWIRE_SLOT_START 6
+#define ONEWIRE_WRITE_ONE_TAIL 64
+#define ONEWIRE_WRITE_ZERO_LOW 60
+#define ONEWIRE_WRITE_ZERO_TAIL 10
+#define ONEWIRE_READ_SAMPLE 9
+#define ONEWIRE_READ_TAIL 55
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static void onewire_WriteBit(uint8 bit);
+static uint8 onewire_ReadBit(void);
+
+bool onewire_Reset(void) {
+    halIntState_t intState;
+    uint8 presence;
+
+    ONEWIRE_LOW();
+    MicroWait(ONEWIRE_RESET_LOW);
+    HAL_ENTER_CRITICAL_SECTION(intState);
+    ONEWIRE_RELEASE();
+    MicroWait(ONEWIRE_PRESENCE_WAIT);
+    presence = !ONEWIRE_READ();
+    HAL_EXIT_CRITICAL_SECTION(intState);
+    MicroWait(ONEWIRE_PRESENCE_TAIL);
+    return presence ? TRUE : FALSE;
+}
+
+static void onewire_WriteBit(uint8 bit) {
+    halIntState_t intState;
+    HAL_ENTER_CRITICAL_SECTION(intState);
+    ONEWIRE_LOW();
+    if (bit) {
+        MicroWait(ONEWIRE_SLOT_START);
+        ONEWIRE_RELEASE();
+        MicroWait(ONEWIRE_WRITE_ONE_TAIL);
+    } else {
+        MicroWait(ONEWIRE_WRITE_ZERO_LOW);
+        ONEWIRE_RELEASE();
+        MicroWait(ONEWIRE_WRITE_ZERO_TAIL);
+    }
+    HAL_EXIT_CRITICAL_SECTION(intState);
+}
+
+static uint8 onewire_ReadBit(void) {
+    halIntState_t intState;
+    uint8 bit;
+    HAL_ENTER_CRITICAL_SECTION(intState);
+    ONEWIRE_LOW();
+    MicroWait(ONEWIRE_SLOT_START);
+    ONEWIRE_RELEASE();
+    MicroWait(ONEWIRE_READ_SAMPLE);
+    bit = ONEWIRE_READ();
+    HAL_EXIT_CRITICAL_SECTION(intState);
+    MicroWait(ONEWIRE_READ_TAIL);
+    return bit;
+}
+
+void onewire_WriteByte(uint8 data) {
+    for (uint8 i = 0; i < 8; i++) {
+        onewire_WriteBit(data & 0x01);
+        data >>= 1;
+    }
+}
+
+uint8 onewire_ReadByte(void) {
+    uint8 data = 0;
+    for (uint8 i = 0; i < 8; i++) {
+        data >>= 1;
+        if (onewire_ReadBit()) {
+            data |= 0x80;
+        }
+    }
+    return data;
+}
+
+uint8 onewire_Search(uint8 (*roms)[ONEWIRE_ROM_SIZE], uint8 maxCount) {
+    uint8 rom[ONEWIRE_ROM_SIZE];
+    uint8 lastDiscrepancy = 0; // bit position of the last branch taken to 0, 0 - whole tree is walked
+    uint8 count = 0;
+
+    osal_memset(rom, 0, sizeof(rom));
+    do {
+        uint8 discrepancy = 0;
+        if (!onewire_Reset()) {
+            break;
+        }
+        onewire_WriteByte(ONEWIRE_CMD_SEARCH_ROM);
+        for (uint8 bit = 1; bit <= ONEWIRE_ROM_SIZE * 8; bit++) {
+            uint8 mask = 1 << ((bit - 1) & 0x07);
+            uint8 *romByte = &rom[(bit - 1) >> 3];
+            uint8 idBit = onewire_ReadBit();
+            uint8 complementBit = onewire_ReadBit();
+            uint8 direction;
+
+            if (idBit && complementBit) {
+                // nobody answered, device was removed during search
+                return count;
+            }
+            if (idBit != complementBit) {
+                direction = idBit;
+            } else {
+                // devices differ at this bit, repeat previous path before last discrepancy, then take 1 branch
+                direction = bit < lastDiscrepancy ? (*romByte & mask) != 0 : bit == lastDiscrepancy;
+                if (!direction) {
+                    discrepancy = bit;
+                }
+            }
+            if (direction) {
+                *romByte |= mask;
+            } else {
+                *romByte &= ~mask;
+            }
+            onewire_WriteBit(direction);
+        }
+        if (onewire_Crc8(rom, ONEWIRE_ROM_SIZE - 1) != rom[ONEWIRE_ROM_SIZE - 1]) {
+            break;
+        }
+        osal_memcpy(roms[count++], rom, ONEWIRE_ROM_SIZE);
+        lastDiscrepancy = discrepancy;
+    } while (lastDiscrepancy != 0 && count < maxCount);
+    return count;
+}
+
+bool onewire_Select(const uint8 *rom) {
+    if (!onewire_Reset()) {
+        return FALSE;
+    }
+    if (rom == NULL) {
+        onewire_WriteByte(ONEWIRE_CMD_SKIP_ROM);
+        return TRUE;
+    }
+    onewire_WriteByte(ONEWIRE_CMD_MATCH_ROM);
+    for (uint8 i = 0; i < ONEWIRE_ROM_SIZE; i++) {
+        onewire_WriteByte(rom[i]);
+    }
+    return TRUE;
+}
+
+uint8 onewire_Crc8(const uint8 *data, uint8 len) {
+    // Dallas/Maxim CRC8, x^8 + x^5 + x^4 + 1
+    uint8 crc = 0;
+    while (len--) {
+        uint8 inbyte = *data++;
+        for (uint8 i = 0; i < 8; i++) {
+            uint8 mix = (crc ^ inbyte) & 0x01;
+            crc >>= 1;
+            if (mix) {
+                crc ^= 0x8C;
+            }
+            inbyte >>= 1;
+        }
+    }
+    return crc;
+}
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef ONEWIRE_H
+#define ONEWIRE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "hal_types.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+#define ONEWIRE_CMD_SEARCH_ROM 0xF0
+#define ONEWIRE_CMD_MATCH_ROM 0x55
+#define ONEWIRE_CMD_SKIP_ROM 0xCC
+
+// family code, 48 bit serial, CRC8
+#define ONEWIRE_ROM_SIZE 8
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+
+/*
+ * Bus reset, returns TRUE when at least one device answered with presence pulse
+ */
+extern bool onewire_Reset(void);
+extern void onewire_WriteByte(uint8 data);
+extern uint8 onewire_ReadByte(void);
+extern uint8 onewire_Crc8(const uint8 *data, uint8 len);
+
+/*
+ * Enumerates devices on the bus with Search ROM, ordered by ROM bits.
+ * Returns number of ROMs with valid CRC written to roms, at most maxCount
+ */
+extern uint8 onewire_Search(uint8 (*roms)[ONEWIRE_ROM_SIZE], uint8 maxCount);
+
+/*
+ * Bus reset followed by Match ROM, or Skip ROM when rom is NULL.
+ * Returns FALSE if nobody answered reset
+ */
+extern bool onewire_Select(const uint8 *rom);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ONEWIRE_H */
@@ -0,0 +1,130 @@
+#include "OSAL.h"
+#include "OSAL_Timers.h"
+#include "ZDApp.h"
+#include "ZGlobals.h"
+#include "nwk_util.h"
+
+#include "Debug.h"
+#include "poll.h"
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+zclPoll_Stats_t zclPoll_Stats = {0, 0, 0, 0};
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+static uint8 pollTaskId = 0;
+static uint16 pollEvent = 0;
+
+static uint32 idleRate = POLL_IDLE_RATE;
+static uint32 fastRate = POLL_FAST_RATE;
+
+static uint8 pollMode = POLL_MODE_STACK;
+static uint32 fastUntil = 0;  // osal_GetSystemClock() when fast window ends
+static uint32 modeSince = 0;  // osal_GetSystemClock() when stats were last updated
+static uint16 fastRemainderMs = 0;
+static uint16 idleRemainderMs = 0;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static void zclPoll_SetMode(uint8 mode);
+static void zclPoll_Accumulate(uint32 *seconds, uint16 *remainderMs, uint32 elapsedMs);
+
+void zclPoll_Init(uint8 taskId, uint16 event) {
+    pollTaskId = taskId;
+    pollEvent = event;
+}
+
+void zclPoll_Fast(uint16 windowMs) {
+    uint32 now = osal_GetSystemClock();
+    // stack polls on its own while joining or rejoining
+    if (devState != DEV_END_DEVICE) {
+        return;
+    }
+    if (pollMode == POLL_MODE_FAST && (int32)(fastUntil - now) >= (int32)windowMs) {
+        return;
+    }
+    fastUntil = now + windowMs;
+    if (pollMode != POLL_MODE_FAST) {
+        zclPoll_Stats.fastWindows++;
+        zclPoll_SetMode(POLL_MODE_FAST);
+    }
+    osal_start_timerEx(pollTaskId, pollEvent, windowMs);
+}
+
+void zclPoll_Stop(void) {
+    if (pollMode != POLL_MODE_FAST) {
+        return;
+    }
+    osal_stop_timerEx(pollTaskId, pollEvent);
+    fastUntil = osal_GetSystemClock();
+    zclPoll_SetMode(POLL_MODE_IDLE);
+}
+
+void zclPoll_SetRates(uint32 idleMs, uint32 fastMs) {
+    idleRate = idleMs;
+    fastRate = fastMs;
+    if (pollMode != POLL_MODE_STACK) {
+        zclPoll_SetMode(pollMode);
+    }
+}
+
+void zclPoll_Process(void) {
+    int32 left = (int32)(fastUntil - osal_GetSystemClock());
+    if (pollMode != POLL_MODE_FAST) {
+        return;
+    }
+    if (left > 0) {
+        osal_start_timerEx(pollTaskId, pollEvent, (uint16)left);
+        return;
+    }
+    zclPoll_SetMode(devState == DEV_END_DEVICE ? POLL_MODE_IDLE : POLL_MODE_STACK);
+}
+
+void zclPoll_Release(void) {
+    if (pollMode == POLL_MODE_STACK) {
+        return;
+    }
+    osal_stop_timerEx(pollTaskId, pollEvent);
+    zclPoll_SetMode(POLL_MODE_STACK);
+}
+
+void zclPoll_UpdateStats(void) {
+    uint32 now = osal_GetSystemClock();
+    uint32 elapsed = now - modeSince;
+    modeSince = now;
+    if (pollMode == POLL_MODE_FAST) {
+        zclPoll_Accumulate(&zclPoll_Stats.fastSeconds, &fastRemainderMs, elapsed);
+    } else if (pollMode == POLL_MODE_IDLE) {
+        zclPoll_Accumulate(&zclPoll_Stats.idleSeconds, &idleRemainderMs, elapsed);
+    }
+}
+
+static void zclPoll_SetMode(uint8 mode) {
+    zclPoll_UpdateStats();
+    pollMode = mode;
+    switch (mode) {
+    case POLL_MODE_FAST:
+        zclPoll_Stats.rate = fastRate;
+        break;
+    case POLL_MODE_IDLE:
+        zclPoll_Stats.rate = idleRate;
+        break;
+    default:
+        // hand back rate stack was configured with
+        zclPoll_Stats.rate = zgPollRate;
+        break;
+    }
+    NLME_SetPollRate(zclPoll_Stats.rate);
+    LREP("Poll mode=%d rate=%ld fast=%lds idle=%lds\r\n", mode, zclPoll_Stats.rate, zclPoll_Stats.fastSeconds,
+         zclPoll_Stats.idleSeconds);
+}
+
+static void zclPoll_Accumulate(uint32 *seconds, uint16 *remainderMs, uint32 elapsedMs) {
+    elapsedMs += *remainderMs;
+    *seconds += elapsedMs / 1000;
+    *remainderMs = (uint16)(elapsedMs % 1000);
+}
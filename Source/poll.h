@@ -0,0 +1,91 @@
+#ifndef POLL_H
+#define POLL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "hal_types.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// defaults, Poll Control cluster can change both at runtime, see zclPoll_SetRates
+
+// parent is polled this fast only while a response or configuration is expected
+#ifndef POLL_FAST_RATE
+#define POLL_FAST_RATE 250 // ms
+#endif
+
+/**
+ * FYI: idle poll doesn't deliver anything useful, parent drops queued frames after few seconds anyway,
+ * it only keeps parent's end device timeout from expiring when heartbeat is off, 0 disables polling
+ * */
+#ifndef POLL_IDLE_RATE
+#define POLL_IDLE_RATE 3600000UL // ms
+#endif
+
+#define POLL_MODE_STACK 0 // not joined, stack manages poll rate itself
+#define POLL_MODE_FAST 1
+#define POLL_MODE_IDLE 2
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+typedef struct {
+    uint32 rate;        // ms, current poll rate, 0 - polling disabled
+    uint32 fastSeconds; // time spent at POLL_FAST_RATE
+    uint32 idleSeconds; // time spent at POLL_IDLE_RATE
+    uint16 fastWindows; // times fast polling was started
+} zclPoll_Stats_t;
+
+/*********************************************************************
+ * VARIABLES
+ */
+extern zclPoll_Stats_t zclPoll_Stats;
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+
+/*
+ * event is started on taskId when fast window expires, it should call zclPoll_Process
+ */
+extern void zclPoll_Init(uint8 taskId, uint16 event);
+
+/*
+ * Polls fast for at least windowMs from now, longer window already running is kept
+ */
+extern void zclPoll_Fast(uint16 windowMs);
+
+/*
+ * Ends fast window right away, e.g. client has nothing more to send
+ */
+extern void zclPoll_Stop(void);
+
+/*
+ * Replaces POLL_IDLE_RATE and POLL_FAST_RATE, current mode is switched to new rate right away
+ */
+extern void zclPoll_SetRates(uint32 idleMs, uint32 fastMs);
+
+/*
+ * Drops to idle rate when fast window is over
+ */
+extern void zclPoll_Process(void);
+
+/*
+ * Device left network or is rejoining, poll rate is up to the stack till next zclPoll_Fast
+ */
+extern void zclPoll_Release(void);
+
+/*
+ * Adds time spent at current rate to zclPoll_Stats
+ */
+extern void zclPoll_UpdateStats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* POLL_H */
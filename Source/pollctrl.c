@@ -0,0 +1,143 @@
+#include "AF.h"
+#include "OSAL.h"
+#include "OSAL_Timers.h"
+#include "ZDApp.h"
+#include "zcl.h"
+
+#include "bdb.h"
+#include "bdb_interface.h"
+
+#include "Debug.h"
+#include "poll.h"
+#include "pollctrl.h"
+#include "zcl_app.h"
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+static uint8 pollCtrlTaskId = 0;
+static uint16 pollCtrlEvent = 0;
+static uint8 pollCtrlEndpoint = 0;
+
+static afAddrType_t pollCtrlDstAddr = {.addrMode = (afAddrMode_t)AddrNotPresent, .endPoint = 0, .addr.shortAddr = 0};
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static ZStatus_t zclPollCtrl_HandleCommand(zclIncoming_t *pInMsg);
+static void zclPollCtrl_CheckInResponse(const uint8 *pData);
+static void zclPollCtrl_Save(void);
+
+void zclPollCtrl_Init(uint8 taskId, uint16 event, uint8 endpoint) {
+    pollCtrlTaskId = taskId;
+    pollCtrlEvent = event;
+    pollCtrlEndpoint = endpoint;
+    zcl_registerPlugin(POLL_CONTROL, POLL_CONTROL, zclPollCtrl_HandleCommand);
+}
+
+void zclPollCtrl_Apply(void) {
+    // FYI: short poll interval is uint16 quarterseconds, up to ~4.5 hours in ms, doesn't fit uint16
+    zclPoll_SetRates(POLLCTRL_QS_TO_MS(zclApp_Config.PollLongInterval), POLLCTRL_QS_TO_MS(zclApp_Config.PollShortInterval));
+    if (zclApp_Config.PollCheckInInterval == 0) {
+        osal_stop_timerEx(pollCtrlTaskId, pollCtrlEvent);
+        return;
+    }
+    osal_start_reload_timer(pollCtrlTaskId, pollCtrlEvent, POLLCTRL_QS_TO_MS(zclApp_Config.PollCheckInInterval));
+}
+
+void zclPollCtrl_CheckIn(void) {
+    if (devState != DEV_END_DEVICE) {
+        return;
+    }
+    ZStatus_t status = zcl_SendCommand(pollCtrlEndpoint, &pollCtrlDstAddr, POLL_CONTROL, COMMAND_POLL_CONTROL_CHECK_IN, TRUE,
+                                       ZCL_FRAME_SERVER_CLIENT_DIR, FALSE, 0, bdb_getZCLFrameCounter(), 0, NULL);
+    LREP("PollCtrl check-in status=%d\r\n", status);
+    if (status == ZSuccess) {
+        zclPoll_Fast(POLLCTRL_RESPONSE_WINDOW);
+    }
+}
+
+bool zclPollCtrl_ValidateAttr(uint16 attrId, const uint8 *data) {
+    switch (attrId) {
+    case ATTRID_POLL_CONTROL_CHECK_IN_INTERVAL: {
+        uint32 interval = BUILD_UINT32(data[0], data[1], data[2], data[3]);
+        // check-in more often than long poll can't be answered anyway
+        return interval == 0 || (interval >= zclApp_Config.PollLongInterval && interval <= POLLCTRL_CHECK_IN_INTERVAL_MAX);
+    }
+    case ATTRID_POLL_CONTROL_FAST_POLL_TIMEOUT:
+        return BUILD_UINT16(data[0], data[1]) != 0;
+    default:
+        return TRUE;
+    }
+}
+
+static ZStatus_t zclPollCtrl_HandleCommand(zclIncoming_t *pInMsg) {
+    uint8 *pData = pInMsg->pData;
+    if (!pInMsg->hdr.fc.clusterSpecific || pInMsg->hdr.fc.direction != ZCL_FRAME_CLIENT_SERVER_DIR) {
+        return ZFailure;
+    }
+    LREP("PollCtrl command=%d len=%d\r\n", pInMsg->hdr.commandID, pInMsg->pDataLen);
+    switch (pInMsg->hdr.commandID) {
+    case COMMAND_POLL_CONTROL_CHECK_IN_RESPONSE:
+        if (pInMsg->pDataLen < 3) {
+            return ZCL_STATUS_MALFORMED_COMMAND;
+        }
+        zclPollCtrl_CheckInResponse(pData);
+        return ZSuccess;
+    case COMMAND_POLL_CONTROL_FAST_POLL_STOP:
+        zclPoll_Stop();
+        return ZSuccess;
+    case COMMAND_POLL_CONTROL_SET_LONG_POLL_INTERVAL: {
+        if (pInMsg->pDataLen < 4) {
+            return ZCL_STATUS_MALFORMED_COMMAND;
+        }
+        uint32 interval = BUILD_UINT32(pData[0], pData[1], pData[2], pData[3]);
+        // long poll can't be faster than short one nor slower than check-in
+        if (interval < zclApp_Config.PollShortInterval ||
+            (zclApp_Config.PollCheckInInterval != 0 && interval > zclApp_Config.PollCheckInInterval)) {
+            return ZCL_STATUS_INVALID_VALUE;
+        }
+        zclApp_Config.PollLongInterval = interval;
+        zclPollCtrl_Save();
+        return ZSuccess;
+    }
+    case COMMAND_POLL_CONTROL_SET_SHORT_POLL_INTERVAL: {
+        if (pInMsg->pDataLen < 2) {
+            return ZCL_STATUS_MALFORMED_COMMAND;
+        }
+        uint16 interval = BUILD_UINT16(pData[0], pData[1]);
+        if (interval == 0 || interval > zclApp_Config.PollLongInterval) {
+            return ZCL_STATUS_INVALID_VALUE;
+        }
+        zclApp_Config.PollShortInterval = interval;
+        zclPollCtrl_Save();
+        return ZSuccess;
+    }
+    default:
+        return ZFailure;
+    }
+}
+
+static void zclPollCtrl_CheckInResponse(const uint8 *pData) {
+    // 0 - use FastPollTimeout attribute
+    uint16 timeout = BUILD_UINT16(pData[1], pData[2]);
+    uint32 windowMs;
+    if (!pData[0]) {
+        zclPoll_Stop();
+        return;
+    }
+    if (timeout == 0) {
+        timeout = zclApp_Config.PollFastTimeout;
+    }
+    // clamped in uint32 first, up to 65535 qs is ~4.5 hours
+    windowMs = POLLCTRL_QS_TO_MS(timeout);
+    if (windowMs > POLLCTRL_FAST_POLL_MAX) {
+        windowMs = POLLCTRL_FAST_POLL_MAX;
+    }
+    zclPoll_Fast((uint16)windowMs);
+}
+
+static void zclPollCtrl_Save(void) {
+    // same path as attribute writes, saves config and calls zclPollCtrl_Apply
+    osal_set_event(pollCtrlTaskId, APP_SAVE_ATTRS_EVT);
+}
@@ -0,0 +1,69 @@
+#ifndef POLLCTRL_H
+#define POLLCTRL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "hal_types.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+#define POLL_CONTROL ZCL_CLUSTER_ID_GEN_POLL_CONTROL
+
+// intervals are in quarter seconds, as in ZCL spec
+#define ATTRID_POLL_CONTROL_CHECK_IN_INTERVAL 0x0000
+#define ATTRID_POLL_CONTROL_LONG_POLL_INTERVAL 0x0001
+#define ATTRID_POLL_CONTROL_SHORT_POLL_INTERVAL 0x0002
+#define ATTRID_POLL_CONTROL_FAST_POLL_TIMEOUT 0x0003
+
+// server to client
+#define COMMAND_POLL_CONTROL_CHECK_IN 0x00
+// client to server
+#define COMMAND_POLL_CONTROL_CHECK_IN_RESPONSE 0x00
+#define COMMAND_POLL_CONTROL_FAST_POLL_STOP 0x01
+#define COMMAND_POLL_CONTROL_SET_LONG_POLL_INTERVAL 0x02
+#define COMMAND_POLL_CONTROL_SET_SHORT_POLL_INTERVAL 0x03
+
+#define POLLCTRL_QS_TO_MS(qs) ((uint32)(qs)*250)
+#define POLLCTRL_CHECK_IN_INTERVAL_MAX 0x6E0000UL // 7 days
+
+// parent holds check-in response for us, wait for it this long
+#ifndef POLLCTRL_RESPONSE_WINDOW
+#define POLLCTRL_RESPONSE_WINDOW 2000 // ms
+#endif
+
+// fast poll timeout asked by client is cut to zclPoll_Fast window limit
+#define POLLCTRL_FAST_POLL_MAX 60000 // ms
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+
+/*
+ * Registers Poll Control cluster commands on endpoint, event is started on taskId when check-in is due,
+ * it should call zclPollCtrl_CheckIn
+ */
+extern void zclPollCtrl_Init(uint8 taskId, uint16 event, uint8 endpoint);
+
+/*
+ * Applies poll intervals and check-in interval from zclApp_Config
+ */
+extern void zclPollCtrl_Apply(void);
+
+/*
+ * Sends Check-in to bound clients and polls fast till response
+ */
+extern void zclPollCtrl_CheckIn(void);
+
+/*
+ * Write validation for Poll Control attributes, data is in ZCL byte order
+ */
+extern bool zclPollCtrl_ValidateAttr(uint16 attrId, const uint8 *data);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* POLLCTRL_H */
@@ -0,0 +1,91 @@
+#include "OSAL.h"
+#include "ZComDef.h"
+
+#include "Debug.h"
+#include "power.h"
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+typedef struct {
+    uint16 millivolts;
+    uint8 percentage; // ZCL units, 0.5 %
+} zclPower_CurvePoint_t;
+
+typedef struct {
+    const zclPower_CurvePoint_t *curve; // descending voltage, last point is empty battery
+    uint8 curveLength;
+    uint16 resistance; // mOhm, internal resistance of the pack late in discharge
+} zclPower_Chemistry_t;
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// FYI: light load discharge, MCU brown out is at 2.0 V, so curves end there
+static const zclPower_CurvePoint_t zclPower_CurveAlkaline2AA[] = {
+    {3100, 200}, {2900, 160}, {2700, 110}, {2500, 60}, {2300, 20}, {2100, 6}, {2000, 0}};
+
+// flat for most of the life, then a steep knee, percentage on the plateau is a rough guess
+static const zclPower_CurvePoint_t zclPower_CurveCR2032[] = {
+    {3000, 200}, {2950, 180}, {2900, 140}, {2850, 100}, {2800, 60}, {2700, 30}, {2500, 10}, {2200, 2}, {2000, 0}};
+
+#define POWER_CURVE(curve) curve, sizeof(curve) / sizeof(curve[0])
+static const zclPower_Chemistry_t zclPower_Chemistries[POWER_CHEMISTRY_COUNT] = {
+    {POWER_CURVE(zclPower_CurveAlkaline2AA), 300},
+    {POWER_CURVE(zclPower_CurveCR2032), 15000}};
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+uint8 zclPower_Level = POWER_LEVEL_NORMAL;
+uint8 zclPower_Percentage = 0;
+uint16 zclPower_CompensatedMv = 0;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static uint8 zclPower_Interpolate(const zclPower_Chemistry_t *chemistry, uint16 millivolts);
+static uint8 zclPower_LevelOf(uint8 percentage);
+
+bool zclPower_Update(uint8 chemistry, uint16 loadedMv) {
+    const zclPower_Chemistry_t *curve = &zclPower_Chemistries[chemistry < POWER_CHEMISTRY_COUNT ? chemistry : 0];
+    uint8 previous = zclPower_Level;
+
+    // uA * mOhm is nV
+    zclPower_CompensatedMv = loadedMv + (uint16)((uint32)POWER_SAMPLE_LOAD_UA * curve->resistance / 1000000UL);
+    zclPower_Percentage = zclPower_Interpolate(curve, zclPower_CompensatedMv);
+
+    uint8 level = zclPower_LevelOf(zclPower_Percentage);
+    uint8 rise = zclPower_LevelOf(zclPower_Percentage > POWER_LEVEL_HYSTERESIS ? zclPower_Percentage - POWER_LEVEL_HYSTERESIS : 0);
+    if (level > zclPower_Level) {
+        zclPower_Level = level;
+    } else if (rise < zclPower_Level) {
+        zclPower_Level = rise;
+    }
+    LREP("Power mv=%d compensated=%d percentage=%d level=%d\r\n", loadedMv, zclPower_CompensatedMv, zclPower_Percentage,
+         zclPower_Level);
+    return zclPower_Level != previous;
+}
+
+static uint8 zclPower_Interpolate(const zclPower_Chemistry_t *chemistry, uint16 millivolts) {
+    const zclPower_CurvePoint_t *curve = chemistry->curve;
+    if (millivolts >= curve[0].millivolts) {
+        return curve[0].percentage;
+    }
+    for (uint8 i = 1; i < chemistry->curveLength; i++) {
+        if (millivolts >= curve[i].millivolts) {
+            uint16 span = curve[i - 1].millivolts - curve[i].millivolts;
+            uint16 above = millivolts - curve[i].millivolts;
+            return curve[i].percentage + (uint8)((uint32)(curve[i - 1].percentage - curve[i].percentage) * above / span);
+        }
+    }
+    return 0;
+}
+
+static uint8 zclPower_LevelOf(uint8 percentage) {
+    if (percentage < POWER_CRITICAL_BELOW) {
+        return POWER_LEVEL_CRITICAL;
+    }
+    return percentage < POWER_SAVING_BELOW ? POWER_LEVEL_SAVING : POWER_LEVEL_NORMAL;
+}
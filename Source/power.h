@@ -0,0 +1,63 @@
+#ifndef POWER_H
+#define POWER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "hal_types.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// BatteryChemistry attribute values, see discharge curves in power.c
+#define POWER_CHEMISTRY_ALKALINE_2AA 0
+#define POWER_CHEMISTRY_CR2032 1
+#define POWER_CHEMISTRY_COUNT 2
+
+/**
+ * FYI: report interval is multiplied and reporting thresholds are scaled by (1 << zclPower_Level),
+ * saving level also drops BME280 oversampling and DS18B20 resolution, critical one skips DS18B20
+ * */
+#define POWER_LEVEL_NORMAL 0
+#define POWER_LEVEL_SAVING 1
+#define POWER_LEVEL_CRITICAL 2
+
+// percentage in ZCL units, 0.5 %
+#ifndef POWER_SAVING_BELOW
+#define POWER_SAVING_BELOW 60 // 30 %
+#endif
+#ifndef POWER_CRITICAL_BELOW
+#define POWER_CRITICAL_BELOW 20 // 10 %
+#endif
+// battery recovers a bit after rest or when it gets warm, level goes back up only this much above threshold
+#define POWER_LEVEL_HYSTERESIS 10 // 5 %
+
+// MCU, ADC and powered sensors while battery is sampled, sag on battery internal resistance is added back
+#ifndef POWER_SAMPLE_LOAD_UA
+#define POWER_SAMPLE_LOAD_UA 8000
+#endif
+
+/*********************************************************************
+ * VARIABLES
+ */
+extern uint8 zclPower_Level;
+extern uint8 zclPower_Percentage;      // ZCL units, 0.5 %
+extern uint16 zclPower_CompensatedMv;  // open circuit estimate of last reading
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+
+/*
+ * Maps battery voltage measured under sensors load through discharge curve of chemistry,
+ * returns TRUE when zclPower_Level changed
+ */
+extern bool zclPower_Update(uint8 chemistry, uint16 loadedMv);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* POWER_H */
@@ -11,6 +11,7 @@
 #define MULTICAST_ENABLED FALSE
 
 #define ZCL_READ
+#define ZCL_WRITE
 #define ZCL_BASIC
 #define ZCL_IDENTIFY
 #define ZCL_REPORTING_DEVICE
@@ -51,6 +52,8 @@
 
 #define SOIL_MOISTURE_PORT 0
 #define SOIL_MOISTURE_PIN 4
+// more soil probes on free P0 pins share excitation and power rail, X(index, pin), see sensors.h
+// #define SOIL_MOISTURE_EXTRA_CHANNELS(X) X(0, 0)
 
 #define LUMOISITY_PORT 0
 #define LUMOISITY_PIN 7
@@ -65,12 +68,24 @@
 
 #endif
 
+// sensors fitted on the board, all are enabled by default, see sensors.h
+// #define APP_SENSOR_BME280 0
+// #define APP_SENSOR_DS18B20 0
+// #define APP_SENSOR_SOIL 0
+// #define APP_SENSOR_ILLUMINANCE 0
+
 
 //i2c bme280
 #define OCM_CLK_PORT 0
 #define OCM_DATA_PORT 0
 #define OCM_CLK_PIN 5
 #define OCM_DATA_PIN 6
+#define OCM_CLK_SBIT P0_5
+#define OCM_CLK_DIR P0DIR
+#define OCM_CLK_SEL P0SEL
+#define OCM_DATA_SBIT P0_6
+#define OCM_DATA_DIR P0DIR
+#define OCM_DATA_SEL P0SEL
 
 
 #ifdef DO_DEBUG_UART
@@ -0,0 +1,172 @@
+#include "OSAL.h"
+#include "OSAL_Nv.h"
+#include "ZComDef.h"
+#include "zcl.h"
+
+#include "Debug.h"
+#include "ds18b20_async.h"
+#include "probes.h"
+#include "zcl_app.h"
+
+#if APP_SENSOR_DS18B20
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+int16 zclProbes_Values[PROBES_MAX];
+uint8 zclProbes_Count = 0;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+static zclProbes_Table_t probesTable;
+static uint8 probesMisses[PROBES_MAX]; // consecutive failed searches and reads of slot's probe
+static bool discoveryDue = FALSE;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static uint8 zclProbes_CountFitted(void);
+static void zclProbes_Missed(uint8 slot);
+
+void zclProbes_Init(void) {
+    osal_memset(&probesTable, 0, sizeof(probesTable));
+    osal_memset(probesMisses, 0, sizeof(probesMisses));
+    uint16 len = osal_nv_item_len(NW_APP_PROBES);
+    if (len != 0 && len != sizeof(probesTable)) {
+        osal_nv_delete(NW_APP_PROBES, len);
+    }
+    if (osal_nv_item_init(NW_APP_PROBES, sizeof(probesTable), &probesTable) == SUCCESS) {
+        osal_nv_read(NW_APP_PROBES, 0, sizeof(probesTable), &probesTable);
+    }
+    zclProbes_Count = zclProbes_CountFitted();
+    discoveryDue = zclProbes_Count == 0;
+    LREP("Probes fitted=%d\r\n", zclProbes_Count);
+}
+
+void zclProbes_RequestDiscovery(void) { discoveryDue = TRUE; }
+
+void zclProbes_Discover(void) {
+    uint8 found[PROBES_MAX][ONEWIRE_ROM_SIZE];
+    zclProbes_Table_t table;
+
+    if (!discoveryDue) {
+        return;
+    }
+    uint8 foundCount = ds18b20_Search(found, PROBES_MAX);
+    LREP("Probes found=%d\r\n", foundCount);
+    // empty bus is searched every cycle, glitch or not, it counts as a miss of every known probe
+    discoveryDue = foundCount == 0;
+
+    /**
+     * FYI: known probe keeps its slot while it's missing, search is repeated every cycle till it's found again
+     * or PROBES_MISSING_AFTER searches in a row missed it, only then slot is freed for a new probe
+     * */
+    osal_memcpy(&table, &probesTable, sizeof(table));
+    for (uint8 slot = 0; slot < PROBES_MAX; slot++) {
+        bool seen = FALSE;
+        if (table.roms[slot][0] == 0) {
+            continue;
+        }
+        for (uint8 i = 0; i < foundCount; i++) {
+            if (found[i][0] != 0 && osal_memcmp(table.roms[slot], found[i], ONEWIRE_ROM_SIZE)) {
+                found[i][0] = 0;
+                seen = TRUE;
+                break;
+            }
+        }
+        if (seen) {
+            probesMisses[slot] = 0;
+            continue;
+        }
+        zclProbes_Missed(slot);
+        if (probesMisses[slot] >= PROBES_MISSING_AFTER) {
+            LREP("Probe %d missing\r\n", slot);
+            osal_memset(table.roms[slot], 0, ONEWIRE_ROM_SIZE);
+            probesMisses[slot] = 0;
+        } else {
+            discoveryDue = TRUE;
+        }
+    }
+    // new probes take free slots only, the rest waits for a slot to be freed
+    uint8 slot = 0;
+    for (uint8 i = 0; i < foundCount; i++) {
+        if (found[i][0] == 0) {
+            continue;
+        }
+        while (slot < PROBES_MAX && table.roms[slot][0] != 0) {
+            slot++;
+        }
+        if (slot == PROBES_MAX) {
+            discoveryDue = TRUE;
+            break;
+        }
+        osal_memcpy(table.roms[slot], found[i], ONEWIRE_ROM_SIZE);
+    }
+
+    if (!osal_memcmp(&table, &probesTable, sizeof(table))) {
+        osal_memcpy(&probesTable, &table, sizeof(table));
+        osal_nv_write(NW_APP_PROBES, 0, sizeof(probesTable), &probesTable);
+    }
+    zclProbes_Count = zclProbes_CountFitted();
+}
+
+bool zclProbes_Fitted(uint8 index) { return index < PROBES_MAX && probesTable.roms[index][0] == DS18B20_FAMILY_CODE; }
+
+bool zclProbes_Read(uint8 index) {
+    int16 temp;
+    if (!zclProbes_Fitted(index)) {
+        return FALSE;
+    }
+    if (!ds18b20_ReadTemperature(probesTable.roms[index], &temp)) {
+        // Match ROM went unanswered or CRC failed, search tells whether probe is still on the bus
+        zclProbes_Missed(index);
+        if (probesMisses[index] >= PROBES_MISSING_AFTER) {
+            discoveryDue = TRUE;
+        }
+        return FALSE;
+    }
+    probesMisses[index] = 0;
+    zclProbes_Values[index] = temp;
+    return TRUE;
+}
+
+ZStatus_t zclProbes_ReadRom(uint8 index, uint8 oper, uint8 *pValue, uint16 *pLen) {
+    uint8 len = zclProbes_Fitted(index) ? ONEWIRE_ROM_SIZE : 0;
+    if (index >= PROBES_MAX) {
+        return ZCL_STATUS_UNSUPPORTED_ATTRIBUTE;
+    }
+    switch (oper) {
+    case ZCL_OPER_LEN:
+        break;
+    case ZCL_OPER_READ:
+        // octet string, length first
+        *pValue++ = len;
+        osal_memcpy(pValue, probesTable.roms[index], len);
+        break;
+    default:
+        return ZCL_STATUS_READ_ONLY;
+    }
+    if (pLen != NULL) {
+        *pLen = len + 1;
+    }
+    return ZCL_STATUS_SUCCESS;
+}
+
+static void zclProbes_Missed(uint8 slot) {
+    if (probesMisses[slot] < 0xFF) {
+        probesMisses[slot]++;
+    }
+}
+
+static uint8 zclProbes_CountFitted(void) {
+    uint8 count = 0;
+    for (uint8 i = 0; i < PROBES_MAX; i++) {
+        if (zclProbes_Fitted(i)) {
+            count++;
+        }
+    }
+    return count;
+}
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef PROBES_H
+#define PROBES_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "ZComDef.h"
+#include "hal_types.h"
+#include "onewire.h"
+#include "sensors.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+#define PROBES_MAX APP_DS18B20_PROBES_MAX
+
+// consecutive searches or Match ROM reads probe has to fail before its slot is freed, single bus glitch keeps it
+#ifndef PROBES_MISSING_AFTER
+#define PROBES_MISSING_AFTER 3
+#endif
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+/**
+ * FYI: slot index is probe number in attributes, persisted in NV so probe keeps its number
+ * across reboots and rediscovery, empty slot has zero family code
+ * */
+typedef struct {
+    uint8 roms[PROBES_MAX][ONEWIRE_ROM_SIZE];
+} zclProbes_Table_t;
+
+/*********************************************************************
+ * VARIABLES
+ */
+extern int16 zclProbes_Values[PROBES_MAX]; // 0.01 C
+extern uint8 zclProbes_Count;              // fitted slots
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+
+/*
+ * Restores probe table from NV, discovery is requested when it's empty
+ */
+extern void zclProbes_Init(void);
+
+/*
+ * Next zclProbes_Discover searches the bus again, e.g. after probe was added or replaced
+ */
+extern void zclProbes_RequestDiscovery(void);
+
+/*
+ * Searches the bus if discovery is requested, sensors have to be powered.
+ * Known probes keep their slots, slot is given to new probe only after PROBES_MISSING_AFTER misses of its probe
+ */
+extern void zclProbes_Discover(void);
+
+extern bool zclProbes_Fitted(uint8 index);
+
+/*
+ * Reads probe after conversion into zclProbes_Values, FALSE on bus or CRC error,
+ * PROBES_MISSING_AFTER failures in a row request discovery
+ */
+extern bool zclProbes_Read(uint8 index);
+
+/*
+ * ZCL read callback for probe ROM attributes, empty slot is read as empty octet string
+ */
+extern ZStatus_t zclProbes_ReadRom(uint8 index, uint8 oper, uint8 *pValue, uint16 *pLen);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PROBES_H */
@@ -0,0 +1,212 @@
+#include "NLMEDE.h"
+#include "OSAL.h"
+#include "OSAL_Timers.h"
+#include "ZDApp.h"
+#include "ZGlobals.h"
+#include "bdb_interface.h"
+
+#include "Debug.h"
+#include "commissioning.h"
+#include "rejoin.h"
+#include "trace.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+// parent lost backoff timer of zstack-lib commissioning task
+#ifndef APP_COMMISSIONING_END_DEVICE_REJOIN_EVT
+#define APP_COMMISSIONING_END_DEVICE_REJOIN_EVT 0x0002
+#endif
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+zclRejoin_Stats_t zclRejoin_Stats = {0, 0, 0, 0};
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+static uint8 rejoinTaskId = 0;
+static uint16 rejoinEvent = 0;
+
+static bool joined = FALSE;          // first join is left to commissioning
+static bool lost = FALSE;            // parent lost, attempts are scheduled
+static bool attemptRunning = FALSE;
+static bool scanCounted = FALSE;
+static bool cachedChannelTried = FALSE;
+static uint32 savedChannelList = 0;  // zgDefaultChannelList while cached channel attempt runs, 0 - not restricted
+static uint32 lostSince = 0;         // osal_GetSystemClock()
+static uint32 attemptSince = 0;
+static uint32 backoff = REJOIN_BACKOFF_MIN;
+static uint32 periodSince = 0;       // budget period start, system clock starts from 0 at reset
+static uint32 periodSpentMs = 0;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static bool zclRejoin_IsRejoining(devStates_t state);
+static void zclRejoin_AttemptBegin(void);
+static void zclRejoin_AttemptEnd(void);
+static void zclRejoin_Schedule(void);
+static uint32 zclRejoin_BudgetLeft(void);
+static void zclRejoin_RestoreChannels(void);
+
+void zclRejoin_Init(uint8 taskId, uint16 event) {
+    rejoinTaskId = taskId;
+    rejoinEvent = event;
+}
+
+uint16 zclRejoin_CommissioningLoop(uint8 task_id, uint16 events) {
+    /**
+     * FYI: commissioning starts its own bdb_ZedAttemptRecoverNwk backoff on BDB_COMMISSIONING_PARENT_LOST,
+     * after first join it would double radio time and bypass budget, so its timer is dropped here
+     * */
+    if (joined && (events & APP_COMMISSIONING_END_DEVICE_REJOIN_EVT)) {
+        LREPMaster("Commissioning rejoin skipped\r\n");
+        events ^= APP_COMMISSIONING_END_DEVICE_REJOIN_EVT;
+        if (events == 0) {
+            return 0;
+        }
+    }
+    return zclCommissioning_event_loop(task_id, events);
+}
+
+void zclRejoin_StateChange(devStates_t state) {
+    if (state == DEV_END_DEVICE) {
+        joined = TRUE;
+        zclRejoin_RestoreChannels();
+        if (lost) {
+            zclRejoin_AttemptEnd();
+            osal_stop_timerEx(rejoinTaskId, rejoinEvent);
+            lost = FALSE;
+            zclRejoin_Stats.lastLossMs = osal_GetSystemClock() - lostSince;
+            LREP("Rejoined after %ldms attempts=%d\r\n", zclRejoin_Stats.lastLossMs, zclRejoin_Stats.attempts);
+        }
+        return;
+    }
+    if (!joined) {
+        return;
+    }
+    if (!lost) {
+        lost = TRUE;
+        lostSince = osal_GetSystemClock();
+        backoff = REJOIN_BACKOFF_MIN;
+        cachedChannelTried = FALSE;
+        LREP("Parent lost state=%d\r\n", state);
+        if (!zclRejoin_IsRejoining(state)) {
+            osal_start_timerEx(rejoinTaskId, rejoinEvent, REJOIN_FIRST_DELAY);
+            return;
+        }
+    }
+    if (zclRejoin_IsRejoining(state)) {
+        // stack may rejoin on its own, radio time counts all the same
+        if (!attemptRunning) {
+            cachedChannelTried = TRUE;
+            zclRejoin_AttemptBegin();
+        }
+        if (!scanCounted && (state == DEV_NWK_SEC_REJOIN_ALL_CHANNEL || state == DEV_NWK_TC_REJOIN_ALL_CHANNEL)) {
+            scanCounted = TRUE;
+            zclRejoin_Stats.scans++;
+        }
+        return;
+    }
+    if (attemptRunning) {
+        zclRejoin_AttemptEnd();
+        zclRejoin_Schedule();
+    }
+}
+
+void zclRejoin_Process(void) {
+    if (attemptRunning) {
+        LREPMaster("Rejoin attempt timed out\r\n");
+        zclRejoin_AttemptEnd();
+        zclRejoin_Schedule();
+        return;
+    }
+    if (!lost || devState == DEV_END_DEVICE) {
+        return;
+    }
+    if (zclRejoin_BudgetLeft() == 0) {
+        zclRejoin_Schedule();
+        return;
+    }
+    if (!cachedChannelTried) {
+        // parent most likely comes back on the same channel, stack falls back to all channels it is given
+        cachedChannelTried = TRUE;
+        savedChannelList = zgDefaultChannelList;
+        zgDefaultChannelList = (uint32)1 << _NIB.nwkLogicalChannel;
+    }
+    zclRejoin_AttemptBegin();
+    if (bdb_ZedAttemptRecoverNwk() != ZSuccess) {
+        zclRejoin_AttemptEnd();
+        zclRejoin_Schedule();
+    }
+}
+
+static bool zclRejoin_IsRejoining(devStates_t state) {
+    switch (state) {
+    case DEV_NWK_SEC_REJOIN_CURR_CHANNEL:
+    case DEV_NWK_SEC_REJOIN_ALL_CHANNEL:
+    case DEV_NWK_TC_REJOIN_CURR_CHANNEL:
+    case DEV_NWK_TC_REJOIN_ALL_CHANNEL:
+    case DEV_END_DEVICE_UNAUTH:
+        return TRUE;
+    default:
+        return FALSE;
+    }
+}
+
+static void zclRejoin_AttemptBegin(void) {
+    attemptRunning = TRUE;
+    scanCounted = FALSE;
+    attemptSince = osal_GetSystemClock();
+    zclRejoin_Stats.attempts++;
+    zclTrace_Record(TRACE_REJOIN, 1);
+    osal_start_timerEx(rejoinTaskId, rejoinEvent, REJOIN_ATTEMPT_TIMEOUT);
+    LREP("Rejoin attempt=%d channels=0x%lX\r\n", zclRejoin_Stats.attempts, zgDefaultChannelList);
+}
+
+static void zclRejoin_AttemptEnd(void) {
+    uint32 spent;
+    // before anything else, stack uses channel list for its own rejoins and commissioning
+    zclRejoin_RestoreChannels();
+    if (!attemptRunning) {
+        return;
+    }
+    spent = osal_GetSystemClock() - attemptSince;
+    attemptRunning = FALSE;
+    osal_stop_timerEx(rejoinTaskId, rejoinEvent);
+    zclTrace_Record(TRACE_REJOIN, 0);
+    // starts new period first, if previous one is over
+    zclRejoin_BudgetLeft();
+    periodSpentMs += spent;
+    zclRejoin_Stats.radioMs += spent;
+}
+
+static void zclRejoin_Schedule(void) {
+    uint32 wait = backoff;
+    backoff = backoff < REJOIN_BACKOFF_MAX / 2 ? backoff * 2 : REJOIN_BACKOFF_MAX;
+    if (zclRejoin_BudgetLeft() == 0) {
+        // FYI: sensors keep reporting into history meanwhile, it is drained after rejoin
+        uint32 periodLeft = REJOIN_BUDGET_PERIOD - (osal_GetSystemClock() - periodSince);
+        wait = MAX(wait, periodLeft);
+    }
+    LREP("Next rejoin attempt in %ldms, spent %ldms today\r\n", wait, periodSpentMs);
+    osal_start_timerEx(rejoinTaskId, rejoinEvent, wait);
+}
+
+static uint32 zclRejoin_BudgetLeft(void) {
+    uint32 now = osal_GetSystemClock();
+    if (now - periodSince >= REJOIN_BUDGET_PERIOD) {
+        periodSince = now;
+        periodSpentMs = 0;
+    }
+    return periodSpentMs < REJOIN_DAILY_BUDGET ? REJOIN_DAILY_BUDGET - periodSpentMs : 0;
+}
+
+static void zclRejoin_RestoreChannels(void) {
+    if (savedChannelList != 0) {
+        zgDefaultChannelList = savedChannelList;
+        savedChannelList = 0;
+    }
+}
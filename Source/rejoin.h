@@ -0,0 +1,85 @@
+#ifndef REJOIN_H
+#define REJOIN_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "ZDApp.h"
+#include "hal_types.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// first attempt after parent loss, only on channel network was using
+#ifndef REJOIN_FIRST_DELAY
+#define REJOIN_FIRST_DELAY 2000UL // ms
+#endif
+
+// full scan attempts follow, delay doubles after each failure up to REJOIN_BACKOFF_MAX
+#ifndef REJOIN_BACKOFF_MIN
+#define REJOIN_BACKOFF_MIN 30000UL // ms
+#endif
+#ifndef REJOIN_BACKOFF_MAX
+#define REJOIN_BACKOFF_MAX 3600000UL // ms
+#endif
+
+// attempt stack didn't finish by then is counted as failed, scanning all channels takes few seconds
+#ifndef REJOIN_ATTEMPT_TIMEOUT
+#define REJOIN_ATTEMPT_TIMEOUT 20000UL // ms
+#endif
+
+/**
+ * FYI: radio time of all attempts within REJOIN_BUDGET_PERIOD, rejoins started by stack itself
+ * are counted too, when budget is spent next attempt waits for next period
+ * */
+#ifndef REJOIN_DAILY_BUDGET
+#define REJOIN_DAILY_BUDGET 300000UL // ms
+#endif
+#define REJOIN_BUDGET_PERIOD 86400000UL // ms
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+typedef struct {
+    uint16 attempts;   // attempts since boot, own and stack's
+    uint16 scans;      // attempts which went on to scan all channels
+    uint32 radioMs;    // cumulative duration of attempts
+    uint32 lastLossMs; // from parent loss till rejoin, of last recovered loss
+} zclRejoin_Stats_t;
+
+/*********************************************************************
+ * VARIABLES
+ */
+extern zclRejoin_Stats_t zclRejoin_Stats;
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+
+/*
+ * event is started on taskId when next attempt is due or running one times out, it should call zclRejoin_Process
+ */
+extern void zclRejoin_Init(uint8 taskId, uint16 event);
+
+/*
+ * Replaces zclCommissioning_event_loop in tasksArr, drops commissioning rejoin timer once network was joined
+ */
+extern uint16 zclRejoin_CommissioningLoop(uint8 task_id, uint16 events);
+
+/*
+ * Feeds ZDO state changes, leaving DEV_END_DEVICE after join starts backoff, returning to it stops
+ */
+extern void zclRejoin_StateChange(devStates_t state);
+
+/*
+ * Starts due attempt or closes timed out one
+ */
+extern void zclRejoin_Process(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* REJOIN_H */
@@ -0,0 +1,285 @@
+#include "AF.h"
+#include "OSAL.h"
+#include "OSAL_Clock.h"
+#include "zcl.h"
+
+#include "ZDApp.h"
+
+#include "bdb.h"
+#include "bdb_interface.h"
+
+#include "Debug.h"
+#include "energy.h"
+#include "reporter.h"
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+typedef struct {
+    uint8 endpoint;
+    uint16 clusterID;
+    uint16 attrID;
+} zclReporter_Item_t;
+
+typedef struct {
+    uint8 endpoint;
+    uint16 clusterID;
+    uint16 attrID;
+    const uint16 *threshold;
+    bool reported;
+    int32 lastReported;
+} zclReporter_Tracked_t;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+static zclReporter_Item_t pendingItems[REPORTER_MAX_ATTRS];
+static uint8 pendingCount = 0;
+
+static zclReporter_Tracked_t trackedItems[REPORTER_MAX_TRACKED];
+static uint8 trackedCount = 0;
+
+static uint8 thresholdShift = 0;
+static bool forceNext = FALSE;
+
+static const uint16 *heartbeatInterval = NULL;
+static bool heartbeatSent = FALSE;
+static uint32 lastHeartbeat = 0;
+
+static afAddrType_t reporterDstAddr = {.addrMode = (afAddrMode_t)AddrNotPresent, .endPoint = 0, .addr.shortAddr = 0};
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static bool zclReporter_SendCluster(uint8 first);
+static void zclReporter_DropCluster(uint8 first);
+static bool zclReporter_ClusterChanged(uint8 first);
+static void zclReporter_ClusterSnapshot(uint8 first, int32 *values, bool *taken);
+static void zclReporter_ClusterReported(const int32 *values, const bool *taken);
+static bool zclReporter_HeartbeatDue(void);
+static bool zclReporter_ReadValue(uint8 endpoint, uint16 clusterID, uint16 attrID, int32 *value);
+static bool zclReporter_IsPending(uint8 first, uint16 attrID);
+
+void zclReporter_Init(const uint16 *heartbeatSeconds) { heartbeatInterval = heartbeatSeconds; }
+
+void zclReporter_Track(uint8 endpoint, uint16 clusterID, uint16 attrID, const uint16 *threshold) {
+    if (trackedCount == REPORTER_MAX_TRACKED) {
+        LREP("Reporter can't track 0x%X 0x%X\r\n", clusterID, attrID);
+        return;
+    }
+    trackedItems[trackedCount].endpoint = endpoint;
+    trackedItems[trackedCount].clusterID = clusterID;
+    trackedItems[trackedCount].attrID = attrID;
+    trackedItems[trackedCount].threshold = threshold;
+    trackedItems[trackedCount].reported = FALSE;
+    trackedItems[trackedCount].lastReported = 0;
+    trackedCount++;
+}
+
+void zclReporter_SetThresholdShift(uint8 shift) { thresholdShift = shift; }
+
+bool zclReporter_CanSend(void) { return bdbAttributes.bdbNodeIsOnANetwork && devState == DEV_END_DEVICE; }
+
+void zclReporter_Mark(uint8 endpoint, uint16 clusterID, uint16 attrID) {
+    for (uint8 i = 0; i < pendingCount; i++) {
+        if (pendingItems[i].endpoint == endpoint && pendingItems[i].clusterID == clusterID && pendingItems[i].attrID == attrID) {
+            return;
+        }
+    }
+    if (pendingCount == REPORTER_MAX_ATTRS) {
+        LREP("Reporter queue is full, dropping 0x%X 0x%X\r\n", clusterID, attrID);
+        return;
+    }
+    pendingItems[pendingCount].endpoint = endpoint;
+    pendingItems[pendingCount].clusterID = clusterID;
+    pendingItems[pendingCount].attrID = attrID;
+    pendingCount++;
+}
+
+void zclReporter_ForceNext(void) { forceNext = TRUE; }
+
+uint8 zclReporter_Flush(uint8 *framesFailed) {
+    uint8 framesSent = 0;
+    uint8 clustersSkipped = 0;
+    int32 snapshot[REPORTER_MAX_TRACKED];
+    bool taken[REPORTER_MAX_TRACKED];
+
+    *framesFailed = 0;
+    if (!zclReporter_CanSend()) {
+        LREP("Reporter has no parent, dropping %d attributes\r\n", pendingCount);
+        pendingCount = 0;
+        return 0;
+    }
+
+    bool heartbeat = zclReporter_HeartbeatDue();
+    bool all = heartbeat || forceNext;
+    forceNext = FALSE;
+    for (uint8 i = 0; i < pendingCount; i++) {
+        // endpoint 0 marks items already handled with previous cluster
+        if (pendingItems[i].endpoint == 0) {
+            continue;
+        }
+        if (!all && !zclReporter_ClusterChanged(i)) {
+            zclReporter_DropCluster(i);
+            clustersSkipped++;
+            continue;
+        }
+        // FYI: values are taken before sending, zclReporter_SendCluster consumes queued items,
+        // but they count as reported only once the frame is handed to the stack
+        zclReporter_ClusterSnapshot(i, snapshot, taken);
+        if (zclReporter_SendCluster(i)) {
+            zclReporter_ClusterReported(snapshot, taken);
+            framesSent++;
+            zclEnergy_CountReport();
+        } else {
+            (*framesFailed)++;
+        }
+    }
+    if (heartbeat && framesSent > 0) {
+        heartbeatSent = TRUE;
+        lastHeartbeat = osal_GetSystemClock();
+    }
+    LREP("Reporter flushed %d attributes in %d frames, skipped %d clusters heartbeat=%d\r\n", pendingCount, framesSent,
+         clustersSkipped, heartbeat);
+    pendingCount = 0;
+    return framesSent;
+}
+
+static bool zclReporter_SendCluster(uint8 first) {
+    uint8 endpoint = pendingItems[first].endpoint;
+    uint16 clusterID = pendingItems[first].clusterID;
+    uint8 numAttr = 0;
+    zclAttrRec_t attrRec;
+
+    for (uint8 i = first; i < pendingCount; i++) {
+        if (pendingItems[i].endpoint == endpoint && pendingItems[i].clusterID == clusterID) {
+            numAttr++;
+        }
+    }
+
+    zclReportCmd_t *pReportCmd = (zclReportCmd_t *)osal_mem_alloc(sizeof(zclReportCmd_t) + (numAttr * sizeof(zclReport_t)));
+    if (pReportCmd == NULL) {
+        LREPMaster("Reporter no memory\r\n");
+        return FALSE;
+    }
+
+    pReportCmd->numAttr = 0;
+    for (uint8 i = first; i < pendingCount; i++) {
+        if (pendingItems[i].endpoint != endpoint || pendingItems[i].clusterID != clusterID) {
+            continue;
+        }
+        if (zclFindAttrRec(endpoint, clusterID, pendingItems[i].attrID, &attrRec)) {
+            zclReport_t *pReport = &pReportCmd->attrList[pReportCmd->numAttr++];
+            pReport->attrID = attrRec.attr.attrId;
+            pReport->dataType = attrRec.attr.dataType;
+            pReport->attrData = (uint8 *)attrRec.attr.dataPtr;
+        }
+        pendingItems[i].endpoint = 0;
+    }
+
+    ZStatus_t status = ZFailure;
+    if (pReportCmd->numAttr > 0) {
+        status = zcl_SendReportCmd(endpoint, &reporterDstAddr, clusterID, pReportCmd, ZCL_FRAME_SERVER_CLIENT_DIR, TRUE,
+                                   bdb_getZCLFrameCounter());
+    }
+    osal_mem_free(pReportCmd);
+    return status == ZSuccess;
+}
+
+static void zclReporter_DropCluster(uint8 first) {
+    uint8 endpoint = pendingItems[first].endpoint;
+    uint16 clusterID = pendingItems[first].clusterID;
+    for (uint8 i = first; i < pendingCount; i++) {
+        if (pendingItems[i].endpoint == endpoint && pendingItems[i].clusterID == clusterID) {
+            pendingItems[i].endpoint = 0;
+        }
+    }
+}
+
+static bool zclReporter_IsPending(uint8 first, uint16 attrID) {
+    for (uint8 i = first; i < pendingCount; i++) {
+        if (pendingItems[i].endpoint == pendingItems[first].endpoint && pendingItems[i].clusterID == pendingItems[first].clusterID &&
+            pendingItems[i].attrID == attrID) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+static bool zclReporter_ClusterChanged(uint8 first) {
+    bool tracked = FALSE;
+    int32 value;
+
+    for (uint8 i = 0; i < trackedCount; i++) {
+        zclReporter_Tracked_t *item = &trackedItems[i];
+        if (item->endpoint != pendingItems[first].endpoint || item->clusterID != pendingItems[first].clusterID) {
+            continue;
+        }
+        tracked = TRUE;
+        // attribute wasn't measured this cycle (e.g. sensor error), nothing new to compare
+        if (!zclReporter_IsPending(first, item->attrID) || !zclReporter_ReadValue(item->endpoint, item->clusterID, item->attrID, &value)) {
+            continue;
+        }
+        int32 delta = value - item->lastReported;
+        if (delta < 0) {
+            delta = -delta;
+        }
+        if (!item->reported || *item->threshold == 0 || delta >= ((int32)*item->threshold << thresholdShift)) {
+            return TRUE;
+        }
+    }
+    return !tracked;
+}
+
+static void zclReporter_ClusterSnapshot(uint8 first, int32 *values, bool *taken) {
+    for (uint8 i = 0; i < trackedCount; i++) {
+        zclReporter_Tracked_t *item = &trackedItems[i];
+        taken[i] = item->endpoint == pendingItems[first].endpoint && item->clusterID == pendingItems[first].clusterID &&
+                   zclReporter_IsPending(first, item->attrID) &&
+                   zclReporter_ReadValue(item->endpoint, item->clusterID, item->attrID, &values[i]);
+    }
+}
+
+static void zclReporter_ClusterReported(const int32 *values, const bool *taken) {
+    for (uint8 i = 0; i < trackedCount; i++) {
+        if (taken[i]) {
+            trackedItems[i].lastReported = values[i];
+            trackedItems[i].reported = TRUE;
+        }
+    }
+}
+
+static bool zclReporter_HeartbeatDue(void) {
+    if (!heartbeatSent) {
+        return TRUE;
+    }
+    if (heartbeatInterval == NULL || *heartbeatInterval == 0) {
+        return FALSE;
+    }
+    uint32 elapsed = osal_GetSystemClock() - lastHeartbeat;
+    return elapsed + REPORTER_HEARTBEAT_TOLERANCE_MS >= (uint32)*heartbeatInterval * 1000;
+}
+
+static bool zclReporter_ReadValue(uint8 endpoint, uint16 clusterID, uint16 attrID, int32 *value) {
+    zclAttrRec_t attrRec;
+    if (!zclFindAttrRec(endpoint, clusterID, attrID, &attrRec)) {
+        return FALSE;
+    }
+    switch (attrRec.attr.dataType) {
+    case ZCL_DATATYPE_INT8:
+        *value = *(int8 *)attrRec.attr.dataPtr;
+        break;
+    case ZCL_DATATYPE_UINT8:
+        *value = *(uint8 *)attrRec.attr.dataPtr;
+        break;
+    case ZCL_DATATYPE_INT16:
+        *value = *(int16 *)attrRec.attr.dataPtr;
+        break;
+    case ZCL_DATATYPE_UINT16:
+        *value = *(uint16 *)attrRec.attr.dataPtr;
+        break;
+    default:
+        return FALSE;
+    }
+    return TRUE;
+}
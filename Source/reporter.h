@@ -0,0 +1,81 @@
+#ifndef REPORTER_H
+#define REPORTER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "hal_types.h"
+
+#include "sensors.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// follow sensors fitted on the board, extra soil channels included
+#ifndef REPORTER_MAX_ATTRS
+#define REPORTER_MAX_ATTRS APP_REPORTED_ATTRS_COUNT
+#endif
+
+#ifndef REPORTER_MAX_TRACKED
+#define REPORTER_MAX_TRACKED APP_TRACKED_ATTRS_COUNT
+#endif
+
+#if REPORTER_MAX_ATTRS < APP_REPORTED_ATTRS_COUNT || REPORTER_MAX_TRACKED < APP_TRACKED_ATTRS_COUNT
+#error "Reporter queues can't hold all attributes of fitted sensors"
+#endif
+
+// report timer is not exact, so heartbeat a bit early rather than a whole cycle late
+#ifndef REPORTER_HEARTBEAT_TOLERANCE_MS
+#define REPORTER_HEARTBEAT_TOLERANCE_MS 60000UL
+#endif
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+
+/*
+ * Sets heartbeat interval in seconds, when it is due all queued attributes are sent
+ * regardless of thresholds, 0 disables heartbeat
+ */
+extern void zclReporter_Init(const uint16 *heartbeatSeconds);
+
+/*
+ * Cluster is reported only when attribute moved at least by *threshold since last report,
+ * 0 reports on every flush. Clusters without tracked attributes are always reported
+ */
+extern void zclReporter_Track(uint8 endpoint, uint16 clusterID, uint16 attrID, const uint16 *threshold);
+
+/*
+ * Thresholds of tracked attributes are multiplied by (1 << shift), e.g. to report less often on low battery
+ */
+extern void zclReporter_SetThresholdShift(uint8 shift);
+
+/*
+ * TRUE when device is joined and has a parent
+ */
+extern bool zclReporter_CanSend(void);
+
+/*
+ * Queue attribute for the next report, attributes of the same cluster/endpoint
+ * are sent in a single Report Attributes frame by zclReporter_Flush
+ */
+extern void zclReporter_Mark(uint8 endpoint, uint16 clusterID, uint16 attrID);
+
+/*
+ * Next flush sends all queued attributes regardless of thresholds, heartbeat schedule isn't affected
+ */
+extern void zclReporter_ForceNext(void);
+
+/*
+ * Sends queued attributes of changed clusters, returns number of frames sent, framesFailed counts frames
+ * which couldn't be handed to the stack, their attributes aren't taken as reported
+ */
+extern uint8 zclReporter_Flush(uint8 *framesFailed);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* REPORTER_H */
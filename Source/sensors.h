@@ -0,0 +1,198 @@
+#ifndef SENSORS_H
+#define SENSORS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * FYI: single list of sensors fitted on the board. Attribute tables, cluster lists, reporter tracking,
+ * acquisition schedule and sensors rail pull-ups are generated from it, so sensor disabled
+ * for the board in preinclude.h costs no code, RAM or wake time
+ * */
+
+/*********************************************************************
+ * CONSTANTS
+ */
+#ifndef APP_SENSOR_BME280
+#define APP_SENSOR_BME280 1
+#endif
+
+#ifndef APP_SENSOR_DS18B20
+#define APP_SENSOR_DS18B20 1
+#endif
+
+// probes on the DS18B20 bus, APP_DS18B20_PROBE_ATTRS and APP_DS18B20_PROBE_TRACKED are listed for each of them
+#define APP_DS18B20_PROBES_MAX 4
+
+#ifndef APP_SENSOR_SOIL
+#define APP_SENSOR_SOIL 1
+#endif
+
+#ifndef SOIL_MOISTURE_EXTRA_CHANNELS
+#define SOIL_MOISTURE_EXTRA_CHANNELS(X)
+#endif
+
+// channel 0 is SOIL_MOISTURE_PIN on the first endpoint, extra channels get endpoints from APP_SOIL_FIRST_EXTRA_EP
+#if APP_SENSOR_SOIL
+#define APP_SOIL_EXTRA_CHANNELS (0 SOIL_MOISTURE_EXTRA_CHANNELS(APP_COUNT))
+#else
+#define APP_SOIL_EXTRA_CHANNELS 0
+#endif
+#define APP_SOIL_CHANNELS (1 + APP_SOIL_EXTRA_CHANNELS)
+#define APP_SOIL_FIRST_EXTRA_EP 3
+
+#ifndef APP_SENSOR_ILLUMINANCE
+#define APP_SENSOR_ILLUMINANCE 1
+#endif
+
+/*********************************************************************
+ * MACROS
+ */
+#if APP_SENSOR_BME280
+#define APP_IF_BME280(...) __VA_ARGS__
+#else
+#define APP_IF_BME280(...)
+#endif
+
+#if APP_SENSOR_DS18B20
+#define APP_IF_DS18B20(...) __VA_ARGS__
+#else
+#define APP_IF_DS18B20(...)
+#endif
+
+#if APP_SENSOR_SOIL
+#define APP_IF_SOIL(...) __VA_ARGS__
+#else
+#define APP_IF_SOIL(...)
+#endif
+
+#if APP_SENSOR_ILLUMINANCE
+#define APP_IF_ILLUMINANCE(...) __VA_ARGS__
+#else
+#define APP_IF_ILLUMINANCE(...)
+#endif
+
+// battery is always sampled, soil and light are added to the same ADC sequence
+#define APP_SOIL_PIN_BIT(index, pin) BV(pin) |
+#define APP_ADC_CHANNELS                                                                                                                   \
+    (APP_IF_SOIL(BV(SOIL_MOISTURE_PIN) | SOIL_MOISTURE_EXTRA_CHANNELS(APP_SOIL_PIN_BIT)) APP_IF_ILLUMINANCE(BV(LUMOISITY_PIN) |) 0)
+
+// X(port), pulled up while sensors are powered, pulled down otherwise so bus doesn't feed unpowered sensors
+#define APP_SENSORS_BUS_PORTS(X) APP_IF_BME280(X(OCM_CLK_PORT) X(OCM_DATA_PORT)) APP_IF_DS18B20(X(DS18B20_PORT))
+
+// X(cluster), out clusters of endpoints
+#define APP_SENSORS_CLUSTERS_FIRST_EP(X) APP_IF_ILLUMINANCE(X(ILLUMINANCE)) APP_IF_BME280(X(TEMP) X(PRESSURE) X(HUMIDITY)) APP_IF_SOIL(X(SOIL_HUMIDITY))
+#define APP_SENSORS_CLUSTERS_SECOND_EP(X) APP_IF_DS18B20(X(TEMP))
+
+// X(cluster, attrId, dataType, accessControl, dataPtr)
+#define APP_SOIL_CHANNEL_ATTRS(X, channel)                                                                                                 \
+    X(SOIL_HUMIDITY, ATTRID_MS_RELATIVE_HUMIDITY_MEASURED_VALUE, ZCL_UINT16, RR, &zclApp_SoilHumiditySensor_MeasuredValue[channel])        \
+    X(SOIL_HUMIDITY, ATTRID_MS_RELATIVE_HUMIDITY_MEASURED_VALUE_RAW_ADC, ZCL_UINT16, RR,                                                   \
+      &zclApp_SoilHumiditySensor_MeasuredValueRawAdc[channel])                                                                             \
+    X(SOIL_HUMIDITY, ATTRID_REPORT_THRESHOLD, ZCL_UINT16, RW, &zclApp_Config.SoilHumidityThreshold)                                        \
+    X(SOIL_HUMIDITY, ATTRID_SOIL_CALIBRATION_AIR, ZCL_INT16, RW, &zclApp_Config.SoilCalibration[channel].AirOffset)                        \
+    X(SOIL_HUMIDITY, ATTRID_SOIL_CALIBRATION_WATER, ZCL_INT16, RW, &zclApp_Config.SoilCalibration[channel].WaterOffset)                    \
+    X(SOIL_HUMIDITY, ATTRID_ADC_SAMPLES, ZCL_UINT8, R, &zclApp_SoilHumiditySensor_Samples[channel])
+#define APP_SOIL_EP_ATTRS_COUNT (0 APP_SOIL_CHANNEL_ATTRS(APP_COUNT, 0))
+
+#define APP_SENSORS_ATTRS_FIRST_EP(X)                                                                                                      \
+    APP_IF_ILLUMINANCE(                                                                                                                    \
+        X(ILLUMINANCE, ATTRID_MS_ILLUMINANCE_MEASURED_VALUE, ZCL_UINT16, RR, &zclApp_IlluminanceSensor_MeasuredValue)                      \
+        X(ILLUMINANCE, ATTRID_REPORT_THRESHOLD, ZCL_UINT16, RW, &zclApp_Config.IlluminanceThreshold)                                       \
+        X(ILLUMINANCE, ATTRID_ADC_SAMPLES, ZCL_UINT8, R, &zclApp_IlluminanceSensor_Samples))                                               \
+    APP_IF_BME280(                                                                                                                         \
+        X(TEMP, ATTRID_MS_TEMPERATURE_MEASURED_VALUE, ZCL_INT16, RR, &zclApp_Temperature_Sensor_MeasuredValue)                             \
+        X(TEMP, ATTRID_REPORT_THRESHOLD, ZCL_UINT16, RW, &zclApp_Config.TemperatureThreshold)                                              \
+        X(PRESSURE, ATTRID_MS_PRESSURE_MEASUREMENT_MEASURED_VALUE, ZCL_INT16, RR, &zclApp_PressureSensor_MeasuredValue)                    \
+        X(PRESSURE, ATTRID_MS_PRESSURE_MEASUREMENT_SCALED_VALUE, ZCL_INT16, RR, &zclApp_PressureSensor_ScaledValue)                        \
+        X(PRESSURE, ATTRID_MS_PRESSURE_MEASUREMENT_SCALE, ZCL_INT8, RR, &zclApp_PressureSensor_Scale)                                      \
+        X(PRESSURE, ATTRID_REPORT_THRESHOLD, ZCL_UINT16, RW, &zclApp_Config.PressureThreshold)                                             \
+        X(HUMIDITY, ATTRID_MS_RELATIVE_HUMIDITY_MEASURED_VALUE, ZCL_UINT16, RR, &zclApp_HumiditySensor_MeasuredValue)                      \
+        X(HUMIDITY, ATTRID_REPORT_THRESHOLD, ZCL_UINT16, RW, &zclApp_Config.HumidityThreshold))                                            \
+    APP_IF_SOIL(                                                                                                                           \
+        APP_SOIL_CHANNEL_ATTRS(X, 0)                                                                                                       \
+        X(SOIL_HUMIDITY, ATTRID_MS_RELATIVE_HUMIDITY_MEASURED_VALUE_BATTERY_RAW_ADC, ZCL_UINT16, RR, &zclBattery_RawAdc)                   \
+        X(SOIL_HUMIDITY, ATTRID_SOIL_EXCITATION_SETTLE, ZCL_UINT16, RW, &zclApp_Config.SoilExcitationSettle)                               \
+        X(SOIL_HUMIDITY, ATTRID_SOIL_EXCITATION_PERIOD, ZCL_UINT8, RW, &zclApp_Config.SoilExcitationPeriod))
+
+// probe ROM is served by zclApp_ReadWriteCB
+#define APP_DS18B20_PROBE_ATTRS(X, index)                                                                                                  \
+    X(TEMP, ATTRID_MS_TEMPERATURE_DS18B20_PROBE_VALUE + (index), ZCL_INT16, RR, &zclProbes_Values[index])                                  \
+    X(TEMP, ATTRID_MS_TEMPERATURE_DS18B20_PROBE_ROM + (index), ZCL_DATATYPE_OCTET_STR, R, NULL)
+
+// measured value mirrors first probe
+#define APP_SENSORS_ATTRS_SECOND_EP(X)                                                                                                     \
+    APP_IF_DS18B20(                                                                                                                        \
+        X(TEMP, ATTRID_MS_TEMPERATURE_MEASURED_VALUE, ZCL_INT16, RR, &zclApp_DS18B20_MeasuredValue)                                        \
+        X(TEMP, ATTRID_MS_TEMPERATURE_DS18B20_RESOLUTION, ZCL_UINT8, RW, &zclApp_Config.DS18B20Resolution)                                 \
+        X(TEMP, ATTRID_MS_TEMPERATURE_DS18B20_PROBES_COUNT, ZCL_UINT8, R, &zclProbes_Count)                                                \
+        X(TEMP, ATTRID_REPORT_THRESHOLD, ZCL_UINT16, RW, &zclApp_Config.DS18B20Threshold)                                                  \
+        APP_DS18B20_PROBE_ATTRS(X, 0)                                                                                                      \
+        APP_DS18B20_PROBE_ATTRS(X, 1)                                                                                                      \
+        APP_DS18B20_PROBE_ATTRS(X, 2)                                                                                                      \
+        APP_DS18B20_PROBE_ATTRS(X, 3))
+
+#define APP_DS18B20_PROBE_TRACKED(X, index)                                                                                                \
+    X(zclApp_SecondEP.EndPoint, TEMP, ATTRID_MS_TEMPERATURE_DS18B20_PROBE_VALUE + (index), &zclApp_Config.DS18B20Threshold)
+
+#define APP_SOIL_EXTRA_TRACKED(X, index)                                                                                                   \
+    X(APP_SOIL_FIRST_EXTRA_EP + (index), SOIL_HUMIDITY, ATTRID_MS_RELATIVE_HUMIDITY_MEASURED_VALUE, &zclApp_Config.SoilHumidityThreshold)
+
+// X(endpoint, cluster, attrId, threshold), see zclReporter_Track, extra soil channels are tracked with APP_SOIL_EXTRA_TRACKED
+#define APP_SENSORS_TRACKED(X)                                                                                                             \
+    APP_IF_BME280(                                                                                                                         \
+        X(zclApp_FirstEP.EndPoint, TEMP, ATTRID_MS_TEMPERATURE_MEASURED_VALUE, &zclApp_Config.TemperatureThreshold)                        \
+        X(zclApp_FirstEP.EndPoint, HUMIDITY, ATTRID_MS_RELATIVE_HUMIDITY_MEASURED_VALUE, &zclApp_Config.HumidityThreshold)                 \
+        X(zclApp_FirstEP.EndPoint, PRESSURE, ATTRID_MS_PRESSURE_MEASUREMENT_MEASURED_VALUE, &zclApp_Config.PressureThreshold))             \
+    APP_IF_ILLUMINANCE(                                                                                                                    \
+        X(zclApp_FirstEP.EndPoint, ILLUMINANCE, ATTRID_MS_ILLUMINANCE_MEASURED_VALUE, &zclApp_Config.IlluminanceThreshold))                \
+    APP_IF_SOIL(                                                                                                                           \
+        X(zclApp_FirstEP.EndPoint, SOIL_HUMIDITY, ATTRID_MS_RELATIVE_HUMIDITY_MEASURED_VALUE, &zclApp_Config.SoilHumidityThreshold))       \
+    X(zclApp_FirstEP.EndPoint, POWER_CFG, ATTRID_POWER_CFG_BATTERY_VOLTAGE, &zclApp_Config.BatteryVoltageThreshold)                        \
+    APP_IF_DS18B20(                                                                                                                        \
+        APP_DS18B20_PROBE_TRACKED(X, 0)                                                                                                    \
+        APP_DS18B20_PROBE_TRACKED(X, 1)                                                                                                    \
+        APP_DS18B20_PROBE_TRACKED(X, 2)                                                                                                    \
+        APP_DS18B20_PROBE_TRACKED(X, 3))
+
+/**
+ * X(startAfter, start, read, needsClock), see zclApp_Acquisition_t, longest conversion first.
+ * ADC sequence also samples battery, so it's always there, soil probe has to settle and needs timer 3 clock
+ * */
+#if APP_SENSOR_SOIL
+#define APP_ADC_START_AFTER (&zclApp_Config.SoilExcitationSettle)
+#define APP_ADC_NEEDS_CLOCK TRUE
+#else
+#define APP_ADC_START_AFTER (&sensorsStartupDelay)
+#define APP_ADC_NEEDS_CLOCK FALSE
+#endif
+
+#define APP_SENSORS_ACQUISITIONS(X)                                                                                                        \
+    APP_IF_DS18B20(X(&sensorsStartupDelay, zclApp_StartDS18B20, zclApp_ReadDS18B20, FALSE))                                                \
+    APP_IF_BME280(X(&sensorsStartupDelay, zclApp_StartBME280, zclApp_ReadBME280, FALSE))                                                   \
+    X(APP_ADC_START_AFTER, zclApp_StartADC, zclApp_ReadADC, APP_ADC_NEEDS_CLOCK)
+
+#define APP_COUNT(...) +1
+
+// X(cluster, attrId, dataType, accessControl, dataPtr) counter of reportable attributes
+#define APP_COUNT_REPORTABLE(cluster, attrId, dataType, accessControl, dataPtr) APP_COUNT_ACCESS_##accessControl
+#define APP_COUNT_ACCESS_RR +1
+#define APP_COUNT_ACCESS_RW
+#define APP_COUNT_ACCESS_R
+
+/**
+ * FYI: sizes of reporter queues, see REPORTER_MAX_ATTRS and REPORTER_MAX_TRACKED. Only reportable attributes are marked,
+ * power configuration adds battery voltage, percentage and raw ADC
+ * */
+#define APP_POWER_CFG_REPORTED_ATTRS 3
+#define APP_REPORTED_ATTRS_COUNT                                                                                                           \
+    (APP_POWER_CFG_REPORTED_ATTRS APP_SENSORS_ATTRS_FIRST_EP(APP_COUNT_REPORTABLE) APP_SENSORS_ATTRS_SECOND_EP(APP_COUNT_REPORTABLE) +     \
+     APP_SOIL_EXTRA_CHANNELS * (0 APP_SOIL_CHANNEL_ATTRS(APP_COUNT_REPORTABLE, 0)))
+#define APP_TRACKED_ATTRS_COUNT (0 APP_SENSORS_TRACKED(APP_COUNT) + APP_SOIL_EXTRA_CHANNELS)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SENSORS_H */
@@ -0,0 +1,83 @@
+#include "OSAL.h"
+#include "ZComDef.h"
+#include "zcl.h"
+
+#include "Debug.h"
+#include "energy.h"
+#include "trace.h"
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+typedef struct {
+    uint32 ticks;
+    uint8 event;
+    uint8 arg;
+} zclTrace_Record_t;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+static zclTrace_Record_t records[TRACE_BUFFER_SIZE];
+static uint16 recordsCount = 0; // total recorded since boot, slot is recordsCount % TRACE_BUFFER_SIZE
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static uint8 zclTrace_SlotSeq(uint8 slot);
+
+void zclTrace_Record(uint8 event, uint8 arg) {
+    zclTrace_Record_t *record = &records[recordsCount % TRACE_BUFFER_SIZE];
+    // FYI: only timer is read here, so tracing doesn't move timings it measures
+    record->ticks = zclEnergy_Ticks();
+    record->event = event;
+    record->arg = arg;
+    recordsCount++;
+}
+
+ZStatus_t zclTrace_ReadPage(uint8 page, uint8 oper, uint8 *pValue, uint16 *pLen) {
+    uint8 len = TRACE_RECORDS_PER_PAGE * TRACE_RECORD_WIRE_SIZE;
+    if (page >= TRACE_PAGES) {
+        return ZCL_STATUS_UNSUPPORTED_ATTRIBUTE;
+    }
+    switch (oper) {
+    case ZCL_OPER_LEN:
+        break;
+    case ZCL_OPER_READ:
+        // octet string, length first, then records of this page in slot order, seq restores time order
+        *pValue++ = len;
+        for (uint8 i = 0; i < TRACE_RECORDS_PER_PAGE; i++) {
+            uint8 slot = page * TRACE_RECORDS_PER_PAGE + i;
+            *pValue++ = zclTrace_SlotSeq(slot);
+            *pValue++ = records[slot].event;
+            *pValue++ = records[slot].arg;
+            *pValue++ = LO_UINT16(LO_UINT32(records[slot].ticks));
+            *pValue++ = HI_UINT16(LO_UINT32(records[slot].ticks));
+            *pValue++ = LO_UINT16(HI_UINT32(records[slot].ticks));
+        }
+        break;
+    default:
+        return ZCL_STATUS_READ_ONLY;
+    }
+    if (pLen != NULL) {
+        *pLen = len + 1;
+    }
+    return ZCL_STATUS_SUCCESS;
+}
+
+void zclTrace_Dump(void) {
+    uint16 first = recordsCount > TRACE_BUFFER_SIZE ? recordsCount - TRACE_BUFFER_SIZE : 0;
+    for (uint16 seq = first; seq < recordsCount; seq++) {
+        uint8 slot = seq % TRACE_BUFFER_SIZE;
+        LREP("TRACE %d %ld %d %d\r\n", seq, records[slot].ticks, records[slot].event, records[slot].arg);
+    }
+}
+
+static uint8 zclTrace_SlotSeq(uint8 slot) {
+    // record number which was last written to slot, lower 8 bits are enough to order single buffer
+    uint16 base = recordsCount - recordsCount % TRACE_BUFFER_SIZE;
+    if (slot >= recordsCount % TRACE_BUFFER_SIZE) {
+        base -= TRACE_BUFFER_SIZE;
+    }
+    return (uint8)(base + slot);
+}
@@ -0,0 +1,59 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "ZComDef.h"
+#include "hal_types.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// records per ZCL attribute page, keeps read response within single unfragmented frame
+#define TRACE_RECORDS_PER_PAGE 8
+#define TRACE_PAGES 4
+#define TRACE_BUFFER_SIZE (TRACE_RECORDS_PER_PAGE * TRACE_PAGES)
+
+// seq, event, arg, 24 bit sleep timer ticks
+#define TRACE_RECORD_WIRE_SIZE 6
+
+// events, arg meaning is in comments
+#define TRACE_CYCLE_START 0x01
+#define TRACE_CYCLE_END 0x02
+#define TRACE_WAKE 0x03           // zclApp_ReadSensors call
+#define TRACE_SENSORS_POWER 0x04  // 1 - on, 0 - off
+#define TRACE_EXCITATION 0x05     // 1 - on, 0 - off
+#define TRACE_HOLD 0x06           // 1 - PWRMGR_HOLD, 0 - PWRMGR_CONSERVE
+#define TRACE_SENSOR_START 0x07   // acquisition index
+#define TRACE_SENSOR_READ 0x08    // acquisition index
+#define TRACE_FLUSH 0x09          // frames sent
+#define TRACE_REJOIN 0x0A         // 1 - attempt started, 0 - ended
+#define TRACE_I2C 0x0B            // bus transactions of preceding sensor start or read
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+
+/*
+ * Appends record with current sleep timer ticks, oldest record is overwritten when buffer is full
+ */
+extern void zclTrace_Record(uint8 event, uint8 arg);
+
+/*
+ * ZCL read callback for trace page attributes, page holds TRACE_RECORDS_PER_PAGE records as octet string
+ */
+extern ZStatus_t zclTrace_ReadPage(uint8 page, uint8 oper, uint8 *pValue, uint16 *pLen);
+
+/*
+ * Prints all records with LREP, one line per record
+ */
+extern void zclTrace_Dump(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TRACE_H */
@@ -7,7 +7,6 @@
 #include "ZDApp.h"
 #include "ZDNwkMgr.h"
 #include "ZDObject.h"
-#include "math.h"
 
 #include "nwk_util.h"
 #include "zcl.h"
@@ -26,12 +25,13 @@
 #include "OnBoard.h"
 
 /* HAL */
+#include "adc_sequence.h"
 #include "bme280.h"
-#include "ds18b20.h"
+#include "ds18b20_async.h"
 #include "hal_adc.h"
 #include "hal_drivers.h"
-#include "hal_i2c.h"
 #include "hal_key.h"
+#include "i2c_fast.h"
 #include "hal_led.h"
 
 #include "battery.h"
@@ -40,36 +40,135 @@
 #include "utils.h"
 #include "version.h"
 
+#include "conversion.h"
+#include "diagnostics.h"
+#include "energy.h"
+#include "history.h"
+#include "poll.h"
+#include "pollctrl.h"
+#include "power.h"
+#include "probes.h"
+#include "rejoin.h"
+#include "reporter.h"
+#include "sensors.h"
+#include "trace.h"
+
 /*********************************************************************
  * MACROS
  */
 #define HAL_KEY_CODE_RELEASE_KEY HAL_KEY_CODE_NOKEY
 
+#define SOIL_EXTRA_PIN_TRI_STATE(index, pin) IO_IMODE_PORT_PIN(SOIL_MOISTURE_PORT, pin, IO_TRI);
+#define APP_READ_SOIL_EXTRA(index, pin) zclApp_ReadSoilHumidity((index) + 1, pin);
+
+#define SENSORS_BUS_PULL_UP(port) IO_PUD_PORT(port, IO_PUP);
+#define SENSORS_BUS_PULL_DOWN(port) IO_PUD_PORT(port, IO_PDN);
+
 // use led4 as output pin, osal will shitch it low when go to PM
 #define POWER_ON_SENSORS()                                                                                                                 \
     do {                                                                                                                                   \
         HAL_TURN_ON_LED4();                                                                                                                \
-        st(T3CTL |= BV(4););                                                                                                               \
-        IO_PUD_PORT(OCM_CLK_PORT, IO_PUP);                                                                                                 \
-        IO_PUD_PORT(OCM_DATA_PORT, IO_PUP);                                                                                                \
-        IO_PUD_PORT(DS18B20_PORT, IO_PUP);                                                                                                 \
+        APP_SENSORS_BUS_PORTS(SENSORS_BUS_PULL_UP)                                                                                         \
     } while (0)
 #define POWER_OFF_SENSORS()                                                                                                                \
     do {                                                                                                                                   \
+        halPowerPinLatched = FALSE;                                                                                                        \
         HAL_TURN_OFF_LED4();                                                                                                               \
-        st(T3CTL &= ~BV(4); T3CTL |= BV(2););                                                                                              \
-        IO_PUD_PORT(OCM_CLK_PORT, IO_PDN);                                                                                                 \
-        IO_PUD_PORT(OCM_DATA_PORT, IO_PDN);                                                                                                \
-        IO_PUD_PORT(DS18B20_PORT, IO_PDN);                                                                                                 \
+        SOIL_EXCITATION_OFF();                                                                                                             \
+        APP_SENSORS_BUS_PORTS(SENSORS_BUS_PULL_DOWN)                                                                                       \
+    } while (0)
+
+#if APP_SENSOR_SOIL
+// timer 3 drives soil probe through P1.4, pin is released to GPIO low while excitation is off
+#define SOIL_EXCITATION_ON()                                                                                                               \
+    do {                                                                                                                                   \
+        T3CC0 = zclApp_Config.SoilExcitationPeriod;                                                                                        \
+        P1SEL |= BV(4);                                                                                                                    \
+        T3CTL |= BV(4);                                                                                                                    \
+    } while (0)
+#define SOIL_EXCITATION_OFF()                                                                                                              \
+    do {                                                                                                                                   \
+        T3CTL &= ~BV(4);                                                                                                                   \
+        T3CTL |= BV(2);                                                                                                                    \
+        P1SEL &= ~BV(4);                                                                                                                   \
+        P1_4 = 0;                                                                                                                          \
+    } while (0)
+#else
+#define SOIL_EXCITATION_ON()
+#define SOIL_EXCITATION_OFF()
+#endif
+
+// FYI: datasheet 9.1 "Measurement time", typical and maximum values in us
+#define BME280_OSR_MULTIPLIER(osr) ((osr) ? ((uint32)1 << ((osr)-1)) : 0)
+#define BME280_MEAS_TIME_BASE_US 1000
+#define BME280_MEAS_TIME_PER_OSR_US 2000
+#define BME280_MEAS_TIME_SETUP_US 500
+#define BME280_MEAS_TIME_MAX_BASE_US 1250
+#define BME280_MEAS_TIME_MAX_PER_OSR_US 2300
+#define BME280_MEAS_TIME_MAX_SETUP_US 575
+
+#ifndef BME280_STATUS_REG_ADDR
+#define BME280_STATUS_REG_ADDR 0xF3
+#endif
+#define BME280_STATUS_MEASURING 0x08
+
+#if APP_SENSOR_BME280
+// single record per sensor start or read, trace buffer would be filled by a single boot cycle of per transaction records
+#define APP_TRACE_I2C()                                                                                                                    \
+    do {                                                                                                                                   \
+        uint8 transactions = i2cFast_TakeTransactions();                                                                                   \
+        if (transactions > 0) {                                                                                                            \
+            zclTrace_Record(TRACE_I2C, transactions);                                                                                      \
+        }                                                                                                                                  \
     } while (0)
+#else
+#define APP_TRACE_I2C()
+#endif
 
 /*********************************************************************
  * CONSTANTS
  */
+#define APP_READ_SENSORS_DELAY 100
+// first samples of every channel, channels whose samples spread more get APP_ADC_EXTRA_SAMPLES more
+#define APP_ADC_SAMPLES 3
+#define APP_ADC_EXTRA_SAMPLES 8
+#define APP_ADC_NOISE_SPREAD 24 // 14 bit counts, ~0.3% of range
+// 14 bit conversion takes 132us, sequence of 2 channels * APP_ADC_SAMPLES should be well within it
+#define APP_ADC_SEQUENCE_TIME 2
+#define APP_ADC_TIMEOUT_US 3000
+#define APP_ADC_INTERNAL_REF_MV 1150 // HAL_ADC_REF_125V, datasheet value is 1.15V
+// darker light readings are sampled again against internal reference, same 14 bits over ~1/3 of AVDD range
+#define APP_LIGHT_LOW_RANGE_MV 1000
+// FYI: BME280 datasheet t_startup, DS18B20 is ready even earlier
+#define APP_SENSORS_STARTUP_DELAY 2
+// BME280 result is read at typical measurement time, then status is polled with this period till maximum one
+#define APP_BME280_POLL_INTERVAL 2
+#define APP_BME280_E_TIMEOUT -16 // still measuring at maximum time, reported as last BME280 error
+
+#define APP_ACQUISITIONS_COUNT (0 APP_SENSORS_ACQUISITIONS(APP_COUNT))
+#define APP_ACQUISITION_PENDING 0
+#define APP_ACQUISITION_RUNNING 1
+#define APP_ACQUISITION_DONE 2
+
+#define APP_SAVE_ATTRS_DELAY 2000
+#define APP_HISTORY_DRAIN_DELAY 2000
+#define APP_HISTORY_FRAME_DELAY 200
+
+// fast poll windows, ms
+#define APP_POLL_REPORT_WINDOW 2000    // coordinator may answer report or push queued writes
+#define APP_POLL_KEY_WINDOW 10000      // user is likely configuring device from frontend
+#define APP_POLL_EXCHANGE_WINDOW 5000  // extended by every write, bind or incoming command
+#define APP_POLL_JOIN_WINDOW 60000     // interview and configure after join
 
 /*********************************************************************
  * TYPEDEFS
  */
+typedef struct {
+    const uint16 *startAfter; // ms since sensors power on, e.g. probe settling time
+    uint16 (*start)(void);    // returns ms till result is ready
+    uint16 (*read)(void);     // returns ms till it's called again, 0 - done
+    bool needsClock; // MCU can't sleep in PM2 till it's read, e.g. timer driven excitation
+} zclApp_Acquisition_t;
 
 /*********************************************************************
  * GLOBAL VARIABLES
@@ -77,6 +176,7 @@
 
 extern bool requestNewTrustCenterLinkKey;
 byte zclApp_TaskID;
+uint8 halPowerPinLatched = FALSE;
 
 /*********************************************************************
  * GLOBAL FUNCTIONS
@@ -86,28 +186,92 @@ byte zclApp_TaskID;
  * LOCAL VARIABLES
  */
 
-static uint8 currentSensorsReadingPhase = 0;
+static bool acquisitionRunning = FALSE;
+static uint32 acquisitionStart = 0;
+static uint8 acquisitionState[APP_ACQUISITIONS_COUNT];
+static uint16 acquisitionDue[APP_ACQUISITIONS_COUNT];
+static const uint16 sensorsStartupDelay = APP_SENSORS_STARTUP_DELAY;
+
+#if APP_SENSOR_BME280
+static bool bme280Calibrated = FALSE;
+static uint8 bme280PollsLeft = 0;
+#endif
+#if APP_SENSOR_DS18B20
+static bool ds18b20Converting = FALSE;
+#endif
+static bool historyStored = FALSE;
+static bool networkJoined = FALSE;
+static bool bootCycle = TRUE;
+static bool bootReportHeld = FALSE; // results of boot cycle wait in reporter queue for join
+
+static uint16 currentReportInterval = 0;
+static uint16 adcReferenceMv = 0; // AVDD is battery voltage, ADC sequence runs against it
+static uint8 currentPowerLevel = POWER_LEVEL_NORMAL; // report timer runs (currentReportInterval << level) seconds
+static bool adaptiveHasPrevious = FALSE;
+static uint32 adaptivePreviousTime = 0;
+static uint16 adaptivePreviousSoilHumidity = 0;
+static int16 adaptivePreviousTemperature = 0;
 
 afAddrType_t inderect_DstAddr = {.addrMode = (afAddrMode_t)AddrNotPresent, .endPoint = 0, .addr.shortAddr = 0};
+#if APP_SENSOR_BME280
 struct bme280_data bme_results;
 struct bme280_dev bme_dev = {.dev_id = BME280_I2C_ADDR_PRIM,
                              .intf = BME280_I2C_INTF,
-                             .read = I2C_ReadMultByte,
-                             .write = I2C_WriteMultByte,
+                             .read = i2cFast_Read,
+                             .write = i2cFast_Write,
                              .delay_ms = user_delay_ms};
+#endif
 /*********************************************************************
  * LOCAL FUNCTIONS
  */
 static void zclApp_HandleKeys(byte shift, byte keys);
+static void zclApp_HandleStateChange(devStates_t state);
+static void zclApp_HandleDataConfirm(afDataConfirm_t *confirm);
 static void zclApp_Report(void);
 
 static void zclApp_ReadSensors(void);
-static void zclApp_InitBME280(struct bme280_dev *dev);
-static void zclApp_ReadBME280(struct bme280_dev *dev);
-static void zclApp_ReadDS18B20(void);
+#if APP_SENSOR_BME280
+static uint16 zclApp_StartBME280(void);
+static uint16 zclApp_BME280MeasurementTime(const struct bme280_settings *settings, bool maximum);
+static uint16 zclApp_ReadBME280(void);
+#endif
+#if APP_SENSOR_DS18B20
+static uint16 zclApp_StartDS18B20(void);
+static uint16 zclApp_ReadDS18B20(void);
+#endif
+static uint16 zclApp_StartADC(void);
+static uint16 zclApp_ReadADC(void);
+static bool zclApp_WaitADC(void);
+static bool zclApp_WaitADCRun(void);
+#if APP_SENSOR_ILLUMINANCE
 static void zclApp_ReadLumosity(void);
-static void zclApp_ReadSoilHumidity(void);
+#endif
+#if APP_SENSOR_SOIL
+static void zclApp_ReadSoilHumidity(uint8 channel, uint8 pin);
 static void zclApp_InitPWM(void);
+#endif
+static void zclApp_ReadBattery(void);
+static void zclApp_StoreHistory(void);
+static void zclApp_StartHistoryDrain(void);
+static void zclApp_FlushReports(void);
+
+static void zclApp_InitReporter(void);
+static void zclApp_ApplyReportInterval(void);
+static void zclApp_SetReportInterval(uint16 interval);
+static void zclApp_AdaptReportInterval(void);
+static uint32 zclApp_RatePerHour(int32 delta, uint32 elapsedSeconds);
+static void zclApp_LoadConfig(void);
+static void zclApp_SaveAttributesToNV(void);
+static uint8 zclApp_ReadWriteAuthCB(afAddrType_t *srcAddr, zclAttrRec_t *pAttr, uint8 oper);
+static ZStatus_t zclApp_ReadWriteCB(uint16 clusterId, uint16 attrId, uint8 oper, uint8 *pValue, uint16 *pLen);
+static ZStatus_t zclApp_HandleFlowerCtrl(zclIncoming_t *pInMsg);
+static uint8 zclApp_ValidateAttrData(zclAttrRec_t *pAttr, zclWriteRec_t *pAttrInfo);
+
+/*********************************************************************
+ * Sensors acquisition table, generated from sensors.h
+ */
+#define APP_ACQUISITION(startAfter, start, read, needsClock) {startAfter, start, read, needsClock},
+static const zclApp_Acquisition_t zclApp_Acquisitions[APP_ACQUISITIONS_COUNT] = {APP_SENSORS_ACQUISITIONS(APP_ACQUISITION)};
 
 /*********************************************************************
  * ZCL General Profile Callback table
@@ -126,33 +290,71 @@ static zclGeneral_AppCallbacks_t zclApp_CmdCallbacks = {
 void zclApp_Init(byte task_id) {
     IO_IMODE_PORT_PIN(SOIL_MOISTURE_PORT, SOIL_MOISTURE_PIN, IO_TRI); // tri state p0.4 (soil humidity pin)
     IO_IMODE_PORT_PIN(LUMOISITY_PORT, LUMOISITY_PIN, IO_TRI); // tri state p0.7 (lumosity pin)
+    SOIL_MOISTURE_EXTRA_CHANNELS(SOIL_EXTRA_PIN_TRI_STATE)
     IO_PUD_PORT(OCM_CLK_PORT, IO_PUP);
     IO_PUD_PORT(OCM_DATA_PORT, IO_PUP)
     IO_PUD_PORT(DS18B20_PORT, IO_PUP);
     POWER_OFF_SENSORS();
 
-    HalI2CInit();
+#if APP_SENSOR_BME280
+    i2cFast_Init();
+#endif
+#if APP_SENSOR_SOIL
     zclApp_InitPWM();
+#endif
     // this is important to allow connects throught routers
     // to make this work, coordinator should be compiled with this flag #define TP2_LEGACY_ZC
     requestNewTrustCenterLinkKey = FALSE;
 
     zclApp_TaskID = task_id;
 
+    zclApp_LoadConfig();
+    zclHistory_Init();
+    zclDiagnostics_Init();
+#if APP_SENSOR_DS18B20
+    zclProbes_Init();
+#endif
+
     zclGeneral_RegisterCmdCallbacks(1, &zclApp_CmdCallbacks);
     zcl_registerAttrList(zclApp_FirstEP.EndPoint, zclApp_AttrsFirstEPCount, zclApp_AttrsFirstEP);
     bdb_RegisterSimpleDescriptor(&zclApp_FirstEP);
 
+    zcl_registerReadWriteCB(zclApp_FirstEP.EndPoint, zclApp_ReadWriteCB, zclApp_ReadWriteAuthCB);
+
+#if APP_SENSOR_DS18B20
     zcl_registerAttrList(zclApp_SecondEP.EndPoint, zclApp_AttrsSecondEPCount, zclApp_AttrsSecondEP);
     bdb_RegisterSimpleDescriptor(&zclApp_SecondEP);
+    zcl_registerReadWriteCB(zclApp_SecondEP.EndPoint, zclApp_ReadWriteCB, zclApp_ReadWriteAuthCB);
+#endif
+#if APP_SOIL_EXTRA_CHANNELS > 0
+    for (uint8 i = 0; i < APP_SOIL_EXTRA_CHANNELS; i++) {
+        zcl_registerAttrList(zclApp_SoilEPs[i].EndPoint, APP_SOIL_EP_ATTRS_COUNT, zclApp_AttrsSoilEPs[i]);
+        bdb_RegisterSimpleDescriptor(&zclApp_SoilEPs[i]);
+        // calibration writes are saved by auth callback
+        zcl_registerReadWriteCB(zclApp_SoilEPs[i].EndPoint, zclApp_ReadWriteCB, zclApp_ReadWriteAuthCB);
+    }
+#endif
+    zcl_registerValidateAttrData(zclApp_ValidateAttrData);
+
+    zclApp_InitReporter();
 
     zcl_registerForMsg(zclApp_TaskID);
 
+    zclPoll_Init(zclApp_TaskID, APP_POLL_EVT);
+    zclPollCtrl_Init(zclApp_TaskID, APP_CHECK_IN_EVT, zclApp_FirstEP.EndPoint);
+    zclPollCtrl_Apply();
+    zcl_registerPlugin(FLOWER_CTRL, FLOWER_CTRL, zclApp_HandleFlowerCtrl);
+    zclRejoin_Init(zclApp_TaskID, APP_REJOIN_EVT);
+    ZDO_RegisterForZDOMsg(zclApp_TaskID, Bind_req);
+    ZDO_RegisterForZDOMsg(zclApp_TaskID, Unbind_req);
+
     // Register for all key events - This app will handle all key events
     RegisterForKeys(zclApp_TaskID);
     LREP("Started build %s \r\n", zclApp_DateCodeNT);
 
-    osal_start_reload_timer(zclApp_TaskID, APP_REPORT_EVT, APP_REPORT_DELAY);
+    zclApp_ApplyReportInterval();
+    // first acquisition runs while network is restored from NV, see bootReportHeld
+    zclApp_Report();
 }
 
 uint16 zclApp_event_loop(uint8 task_id, uint16 events) {
@@ -165,10 +367,21 @@ uint16 zclApp_event_loop(uint8 task_id, uint16 events) {
             case KEY_CHANGE:
                 zclApp_HandleKeys(((keyChange_t *)MSGpkt)->state, ((keyChange_t *)MSGpkt)->keys);
                 break;
+            case ZDO_STATE_CHANGE:
+                zclApp_HandleStateChange((devStates_t)(MSGpkt->hdr.status));
+                break;
+            case AF_DATA_CONFIRM_CMD:
+                zclApp_HandleDataConfirm((afDataConfirm_t *)MSGpkt);
+                break;
             case ZCL_INCOMING_MSG:
                 if (((zclIncomingMsg_t *)MSGpkt)->attrCmd) {
                     osal_mem_free(((zclIncomingMsg_t *)MSGpkt)->attrCmd);
                 }
+                zclPoll_Fast(APP_POLL_EXCHANGE_WINDOW);
+                break;
+            case ZDO_CB_MSG:
+                // bind or unbind, configure reporting usually follows
+                zclPoll_Fast(APP_POLL_EXCHANGE_WINDOW);
                 break;
 
             default:
@@ -187,9 +400,45 @@ uint16 zclApp_event_loop(uint8 task_id, uint16 events) {
         return (events ^ APP_REPORT_EVT);
     }
 
+    if (events & APP_SAVE_ATTRS_EVT) {
+        LREPMaster("APP_SAVE_ATTRS_EVT\r\n");
+        zclApp_SaveAttributesToNV();
+        zclApp_ApplyReportInterval();
+        zclPollCtrl_Apply();
+        return (events ^ APP_SAVE_ATTRS_EVT);
+    }
+
+    if (events & APP_HISTORY_EVT) {
+        LREPMaster("APP_HISTORY_EVT\r\n");
+        if (zclHistory_SendNext(zclApp_FirstEP.EndPoint)) {
+            osal_start_timerEx(zclApp_TaskID, APP_HISTORY_EVT, APP_HISTORY_FRAME_DELAY);
+        }
+        return (events ^ APP_HISTORY_EVT);
+    }
+
+    if (events & APP_POLL_EVT) {
+        zclPoll_Process();
+        return (events ^ APP_POLL_EVT);
+    }
+
+    if (events & APP_CHECK_IN_EVT) {
+        LREPMaster("APP_CHECK_IN_EVT\r\n");
+        zclPollCtrl_CheckIn();
+        return (events ^ APP_CHECK_IN_EVT);
+    }
+
+    if (events & APP_REJOIN_EVT) {
+        LREPMaster("APP_REJOIN_EVT\r\n");
+        zclRejoin_Process();
+        return (events ^ APP_REJOIN_EVT);
+    }
+
     if (events & APP_READ_SENSORS_EVT) {
         LREPMaster("APP_READ_SENSORS_EVT\r\n");
+        zclDiagnostics_Wake();
+        zclEnergy_ActivityBegin();
         zclApp_ReadSensors();
+        zclEnergy_ActivityEnd();
         return (events ^ APP_READ_SENSORS_EVT);
     }
 
@@ -203,15 +452,60 @@ static void zclApp_HandleKeys(byte portAndAction, byte keyCode) {
     zclCommissioning_HandleKeys(portAndAction, keyCode);
     if (portAndAction & HAL_KEY_PRESS) {
         LREPMaster("Key press\r\n");
+        // previous cycle, before key press starts new one
+        zclTrace_Dump();
+#if APP_SENSOR_DS18B20
+        // probe may have been added or replaced
+        zclProbes_RequestDiscovery();
+#endif
+        zclPoll_Fast(APP_POLL_KEY_WINDOW);
         osal_start_timerEx(zclApp_TaskID, APP_REPORT_EVT, 200);
     }
 }
+static void zclApp_HandleStateChange(devStates_t state) {
+    LREP("zclApp_HandleStateChange state=%d\r\n", state);
+    // acquisition keeps its own timers, results go to history till rejoin
+    zclRejoin_StateChange(state);
+    if (state == DEV_END_DEVICE) {
+        // parent was lost since first join of this boot
+        if (networkJoined) {
+            zclDiagnostics_Rejoin();
+        }
+        networkJoined = TRUE;
+        if (bootReportHeld) {
+            bootReportHeld = FALSE;
+            zclApp_FlushReports();
+        }
+        zclPoll_Fast(APP_POLL_JOIN_WINDOW);
+        zclApp_StartHistoryDrain();
+    } else {
+        zclPoll_Release();
+    }
+}
+
+static void zclApp_HandleDataConfirm(afDataConfirm_t *confirm) {
+    zclDiagnostics_FrameConfirmed(confirm->hdr.status);
+    if (confirm->hdr.status == ZSuccess) {
+        zclPoll_Fast(APP_POLL_REPORT_WINDOW);
+        return;
+    }
+    LREP("zclApp_HandleDataConfirm status=0x%X\r\n", confirm->hdr.status);
+    if (zclHistory_IsDraining()) {
+        osal_stop_timerEx(zclApp_TaskID, APP_HISTORY_EVT);
+        zclHistory_Abort();
+    } else {
+        zclApp_StoreHistory();
+    }
+}
+
+#if APP_SENSOR_SOIL
 static void zclApp_InitPWM(void) {
     PERCFG &= ~(0x20); // Select Timer 3 Alternative 1 location
     P2SEL |= 0x20;
     P2DIR |= 0xC0;  // Give priority to Timer 1 channel2-3
-    P1SEL |= BV(4); // Set P1_4 to peripheral, Timer 1,channel 2
+    P1SEL &= ~BV(4); // P1_4 is switched to peripheral, Timer 3 channel 1, only while soil is excited
     P1DIR |= BV(4);
+    P1_4 = 0;
 
     T3CTL &= ~BV(4); // Stop timer 3 (if it was running)
     T3CTL |= BV(2);  // Clear timer 3
@@ -223,118 +517,553 @@ static void zclApp_InitPWM(void) {
     T3CCTL1 |= BV(4); // Ch0 output compare mode = toggle on compare
 
     T3CTL &= ~(BV(7) | BV(6) | BV(5)); // Clear Prescaler divider value
-    T3CC0 = 4;                         // Set ticks
+    T3CC0 = zclApp_Config.SoilExcitationPeriod; // Set ticks
 }
+#endif
 
 static void zclApp_ReadSensors(void) {
-    LREP("currentSensorsReadingPhase %d\r\n", currentSensorsReadingPhase);
+    uint16 elapsed;
+    uint16 nextDue = 0;
+    bool busy = FALSE;
+    bool needsClock = FALSE;
     /**
-     * FYI: split reading sensors into phases, so single call wouldn't block processor
-     * for extensive ammount of time
+     * FYI: every sensor is started as soon as it's powered and settled, so conversions overlap,
+     * MCU wakes only when next result is due and sensors are powered off right after the last one
      * */
-    HalLedSet(HAL_LED_1, HAL_LED_MODE_BLINK);
-    switch (currentSensorsReadingPhase++) {
-    case 0:
+    if (!acquisitionRunning) {
+        acquisitionRunning = TRUE;
+        HalLedSet(HAL_LED_1, HAL_LED_MODE_BLINK);
+        zclEnergy_CycleStart();
+        historyStored = FALSE;
         POWER_ON_SENSORS();
-        zclApp_ReadLumosity();
-        osal_pwrmgr_task_state(zclApp_TaskID, PWRMGR_HOLD);
-        break;
-
-    case 1:
-        zclBattery_Report();
-        zclApp_ReadSoilHumidity();
-        break;
-    case 2:
-        zclApp_InitBME280(&bme_dev);
-        break;
-
-    case 3:
-        zclApp_ReadBME280(&bme_dev);
-        osal_pwrmgr_task_state(zclApp_TaskID, PWRMGR_CONSERVE);
-        break;
+        zclEnergy_SensorsPower(TRUE);
+        // let MCU sleep in PM2 between results, but keep sensors powered
+        halPowerPinLatched = TRUE;
+#if APP_SENSOR_SOIL
+        SOIL_EXCITATION_ON();
+        zclEnergy_Excitation(TRUE);
+#endif
+        osal_memset(acquisitionState, APP_ACQUISITION_PENDING, sizeof(acquisitionState));
+        acquisitionStart = osal_GetSystemClock();
+    }
 
-    case 4:
-        zclApp_ReadDS18B20();
-        break;
-    default:
+    elapsed = (uint16)(osal_GetSystemClock() - acquisitionStart);
+    zclTrace_Record(TRACE_WAKE, 0);
+    for (uint8 i = 0; i < APP_ACQUISITIONS_COUNT; i++) {
+        const zclApp_Acquisition_t *acquisition = &zclApp_Acquisitions[i];
+        uint16 due;
+        if (acquisitionState[i] == APP_ACQUISITION_PENDING && elapsed >= *acquisition->startAfter) {
+            zclTrace_Record(TRACE_SENSOR_START, i);
+            acquisitionDue[i] = elapsed + acquisition->start();
+            acquisitionState[i] = APP_ACQUISITION_RUNNING;
+            APP_TRACE_I2C();
+        }
+        if (acquisitionState[i] == APP_ACQUISITION_RUNNING && elapsed >= acquisitionDue[i]) {
+            uint16 again = acquisition->read();
+            zclTrace_Record(TRACE_SENSOR_READ, i);
+            APP_TRACE_I2C();
+            if (again > 0) {
+                acquisitionDue[i] = elapsed + again;
+            } else {
+                acquisitionState[i] = APP_ACQUISITION_DONE;
+            }
+        }
+        if (acquisitionState[i] == APP_ACQUISITION_DONE) {
+            continue;
+        }
+        due = (acquisitionState[i] == APP_ACQUISITION_PENDING) ? *acquisition->startAfter : acquisitionDue[i];
+        nextDue = busy ? MIN(nextDue, due) : due;
+        busy = TRUE;
+        needsClock |= acquisition->needsClock;
+    }
+
+    if (!busy) {
+        LREP("ReadSensors done in %dms\r\n", elapsed);
         POWER_OFF_SENSORS();
-        osal_stop_timerEx(zclApp_TaskID, APP_READ_SENSORS_EVT);
-        osal_clear_event(zclApp_TaskID, APP_READ_SENSORS_EVT);
-        currentSensorsReadingPhase = 0;
-        break;
+        zclEnergy_SensorsPower(FALSE);
+        osal_pwrmgr_task_state(zclApp_TaskID, PWRMGR_CONSERVE);
+        zclEnergy_Hold(FALSE);
+        acquisitionRunning = FALSE;
+        if (bootCycle && !zclReporter_CanSend()) {
+            // rejoin after reset takes a moment, so don't wait whole report interval for it
+            LREPMaster("Holding boot report till join\r\n");
+            bootReportHeld = TRUE;
+        } else {
+            bootReportHeld = FALSE;
+            if (!zclReporter_CanSend()) {
+                zclApp_StoreHistory();
+            }
+            zclApp_FlushReports();
+        }
+        bootCycle = FALSE;
+        zclApp_StartHistoryDrain();
+        zclPoll_UpdateStats();
+        zclEnergy_CycleEnd();
+        zclDiagnostics_CycleEnd();
+        zclApp_AdaptReportInterval();
+        return;
+    }
+
+    osal_pwrmgr_task_state(zclApp_TaskID, needsClock ? PWRMGR_HOLD : PWRMGR_CONSERVE);
+    zclEnergy_Hold(needsClock);
+    // starting and reading sensors takes time too
+    elapsed = (uint16)(osal_GetSystemClock() - acquisitionStart);
+    osal_start_timerEx(zclApp_TaskID, APP_READ_SENSORS_EVT, nextDue > elapsed ? nextDue - elapsed : 1);
+}
+
+static void zclApp_ReadBattery(void) {
+    uint16 millivolts;
+    // FYI: same VDD/3 conversion as zstack-lib getBatteryVoltage, but without float math
+    HalAdcSetReference(HAL_ADC_REF_125V);
+    zclBattery_RawAdc = HalAdcRead(HAL_ADC_CHANNEL_VDD, HAL_ADC_RESOLUTION_14);
+    millivolts = convertBatteryMv(zclBattery_RawAdc);
+    adcReferenceMv = millivolts;
+    zclBattery_Voltage = convertBatteryZCL(millivolts);
+    LREP("ReadBattery mv=%d raw=%d\r\n", millivolts, zclBattery_RawAdc);
+    // sampled with sensors powered, new level applies from the next cycle
+    if (zclPower_Update(zclApp_Config.BatteryChemistry, millivolts)) {
+        zclReporter_SetThresholdShift(zclPower_Level);
+        zclApp_SetReportInterval(currentReportInterval);
+    }
+    zclBattery_PercentageRemainig = zclPower_Percentage;
+
+    zclReporter_Mark(zclApp_FirstEP.EndPoint, POWER_CFG, ATTRID_POWER_CFG_BATTERY_VOLTAGE);
+    zclReporter_Mark(zclApp_FirstEP.EndPoint, POWER_CFG, ATTRID_POWER_CFG_BATTERY_PERCENTAGE_REMAINING);
+    zclReporter_Mark(zclApp_FirstEP.EndPoint, POWER_CFG, ATTRID_POWER_CFG_BATTERY_VOLTAGE_RAW_ADC);
+#if APP_SENSOR_SOIL
+    zclReporter_Mark(zclApp_FirstEP.EndPoint, SOIL_HUMIDITY, ATTRID_MS_RELATIVE_HUMIDITY_MEASURED_VALUE_BATTERY_RAW_ADC);
+#endif
+}
+
+static void zclApp_StoreHistory(void) {
+    zclHistory_Record_t record;
+    // single record per cycle, even if several frames failed
+    if (historyStored || !bdbAttributes.bdbNodeIsOnANetwork) {
+        return;
+    }
+    historyStored = TRUE;
+    record.timestamp = osal_getClock();
+    record.temperature = zclApp_Temperature_Sensor_MeasuredValue;
+    record.humidity = zclApp_HumiditySensor_MeasuredValue;
+    record.pressure = zclApp_PressureSensor_MeasuredValue;
+    record.illuminance = zclApp_IlluminanceSensor_MeasuredValue;
+    record.soilHumidity = zclApp_SoilHumiditySensor_MeasuredValue[0];
+    record.ds18b20Temperature = zclApp_DS18B20_MeasuredValue;
+    record.batteryVoltage = zclBattery_Voltage;
+    record.reserved = 0;
+    zclHistory_Store(&record);
+}
+
+static void zclApp_StartHistoryDrain(void) {
+    if (zclReporter_CanSend() && !zclHistory_IsDraining() && zclHistory_Pending() > 0) {
+        osal_start_timerEx(zclApp_TaskID, APP_HISTORY_EVT, APP_HISTORY_DRAIN_DELAY);
+    }
+}
+
+static void zclApp_FlushReports(void) {
+    uint8 framesFailed;
+    uint8 framesSent = zclReporter_Flush(&framesFailed);
+    zclTrace_Record(TRACE_FLUSH, framesSent);
+    if (framesFailed > 0) {
+        // same as failed data confirm, values never left the device
+        zclApp_StoreHistory();
+    }
+    if (framesSent > 0) {
+        zclDiagnostics_Reported();
+    }
+}
+
+static uint16 zclApp_StartADC(void) {
+    if (APP_ADC_CHANNELS == 0) {
+        // battery only, it's read with separate conversion
+        return 0;
+    }
+    if (!adcSequence_Start(APP_ADC_CHANNELS, HAL_ADC_RESOLUTION_14, HAL_ADC_REF_AVDD, APP_ADC_SAMPLES)) {
+        LREPMaster("StartADC error\r\n");
+        return 0;
+    }
+    return APP_ADC_SEQUENCE_TIME;
+}
+
+static bool zclApp_WaitADCRun(void) {
+    uint16 timeout = APP_ADC_TIMEOUT_US / 100;
+    while (!adcSequence_IsDone() && timeout--) {
+        MicroWait(100);
     }
+    return adcSequence_Stop();
 }
 
-static void zclApp_ReadSoilHumidity(void) {
-    zclApp_SoilHumiditySensor_MeasuredValueRawAdc = adcReadSampled(SOIL_MOISTURE_PIN, HAL_ADC_RESOLUTION_14, HAL_ADC_REF_AVDD, 5);
+static bool zclApp_WaitADC(void) {
+    if (!zclApp_WaitADCRun()) {
+        return FALSE;
+    }
+    // quiet channels are done after first few samples, noisy ones get more and their spikes are trimmed
+    uint8 noisy = adcSequence_NoisyChannels(APP_ADC_NOISE_SPREAD);
+    if (noisy == 0 || !adcSequence_Extend(noisy, APP_ADC_EXTRA_SAMPLES)) {
+        return TRUE;
+    }
+    LREP("WaitADC noisy=0x%X\r\n", noisy);
+    return zclApp_WaitADCRun();
+}
+
+static uint16 zclApp_ReadADC(void) {
+    bool complete = zclApp_WaitADC();
+#if APP_SENSOR_SOIL
+    SOIL_EXCITATION_OFF();
+    zclEnergy_Excitation(FALSE);
+#endif
+    if (!complete) {
+        LREPMaster("ReadADC sequence not complete\r\n");
+        return 0;
+    }
+    // battery right after soil samples, it's used to compensate them
+    zclApp_ReadBattery();
+#if APP_SENSOR_SOIL
+    zclApp_ReadSoilHumidity(0, SOIL_MOISTURE_PIN);
+    SOIL_MOISTURE_EXTRA_CHANNELS(APP_READ_SOIL_EXTRA)
+#endif
+#if APP_SENSOR_ILLUMINANCE
+    zclApp_ReadLumosity();
+#endif
+    return 0;
+}
+
+#if APP_SENSOR_SOIL
+static void zclApp_ReadSoilHumidity(uint8 channel, uint8 pin) {
+    uint8 endpoint = channel == 0 ? zclApp_FirstEP.EndPoint : APP_SOIL_FIRST_EXTRA_EP + channel - 1;
+    zclApp_SoilCalibration_t *calibration = &zclApp_Config.SoilCalibration[channel];
+
+    zclApp_SoilHumiditySensor_MeasuredValueRawAdc[channel] = adcSequence_Result(pin);
+    zclApp_SoilHumiditySensor_Samples[channel] = adcSequence_Samples(pin);
     // FYI: https://docs.google.com/spreadsheets/d/1qrFdMTo0ZrqtlGUoafeB3hplhU3GzDnVWuUK4M9OgNo/edit?usp=sharing
-    uint16 soilHumidityMinRangeAir = (uint16)AIR_COMPENSATION_FORMULA(zclBattery_RawAdc);
-    uint16 soilHumidityMaxRangeWater = (uint16)WATER_COMPENSATION_FORMULA(zclBattery_RawAdc);
+    uint16 soilHumidityMinRangeAir = convertSoilAirAdc(zclBattery_RawAdc) + calibration->AirOffset;
+    uint16 soilHumidityMaxRangeWater = convertSoilWaterAdc(zclBattery_RawAdc) + calibration->WaterOffset;
     LREP("soilHumidityMinRangeAir=%d soilHumidityMaxRangeWater=%d\r\n", soilHumidityMinRangeAir, soilHumidityMaxRangeWater);
-    zclApp_SoilHumiditySensor_MeasuredValue =
-        (uint16)mapRange(soilHumidityMinRangeAir, soilHumidityMaxRangeWater, 0.0, 10000.0, zclApp_SoilHumiditySensor_MeasuredValueRawAdc);
-    LREP("ReadSoilHumidity raw=%d mapped=%d\r\n", zclApp_SoilHumiditySensor_MeasuredValueRawAdc, zclApp_SoilHumiditySensor_MeasuredValue);
+    zclApp_SoilHumiditySensor_MeasuredValue[channel] =
+        mapSoilHumidity(zclApp_SoilHumiditySensor_MeasuredValueRawAdc[channel], soilHumidityMinRangeAir, soilHumidityMaxRangeWater);
+    LREP("ReadSoilHumidity channel=%d raw=%d samples=%d mapped=%d\r\n", channel, zclApp_SoilHumiditySensor_MeasuredValueRawAdc[channel],
+         zclApp_SoilHumiditySensor_Samples[channel],
+         zclApp_SoilHumiditySensor_MeasuredValue[channel]);
 
-    bdb_RepChangedAttrValue(zclApp_FirstEP.EndPoint, SOIL_HUMIDITY, ATTRID_MS_RELATIVE_HUMIDITY_MEASURED_VALUE);
+    zclReporter_Mark(endpoint, SOIL_HUMIDITY, ATTRID_MS_RELATIVE_HUMIDITY_MEASURED_VALUE);
+    zclReporter_Mark(endpoint, SOIL_HUMIDITY, ATTRID_MS_RELATIVE_HUMIDITY_MEASURED_VALUE_RAW_ADC);
 }
+#endif
 
-static void zclApp_ReadDS18B20(void) {
-    int16 temp = readTemperature();
-    if (temp != 1) {
-        zclApp_DS18B20_MeasuredValue = temp;
-        LREP("ReadDS18B20 t=%d\r\n", zclApp_DS18B20_MeasuredValue);
-        bdb_RepChangedAttrValue(zclApp_SecondEP.EndPoint, TEMP, ATTRID_MS_TEMPERATURE_MEASURED_VALUE);
-    } else {
-        LREPMaster("ReadDS18B20 error\r\n");
+#if APP_SENSOR_DS18B20
+static uint16 zclApp_StartDS18B20(void) {
+    uint8 resolution = zclApp_Config.DS18B20Resolution;
+    if (zclPower_Level == POWER_LEVEL_CRITICAL) {
+        // 12 bit conversion keeps sensors powered longer than all others together, probes keep last values
+        return 0;
+    }
+    if (zclPower_Level == POWER_LEVEL_SAVING) {
+        resolution = DS18B20_RESOLUTION_MIN;
     }
+    zclProbes_Discover();
+    ds18b20Converting = ds18b20_StartConversion(resolution);
+    if (!ds18b20Converting) {
+        LREPMaster("StartDS18B20 error\r\n");
+        zclDiagnostics_SensorError(DIAGNOSTICS_SENSOR_DS18B20, 0);
+        return 0;
+    }
+    return ds18b20_ConversionTime(resolution);
 }
 
+static uint16 zclApp_ReadDS18B20(void) {
+    if (!ds18b20Converting) {
+        return 0;
+    }
+    ds18b20Converting = FALSE;
+    // all probes converted together, only scratchpads are read one by one
+    for (uint8 i = 0; i < PROBES_MAX; i++) {
+        if (!zclProbes_Fitted(i)) {
+            continue;
+        }
+        if (!zclProbes_Read(i)) {
+            LREP("ReadDS18B20 probe %d error\r\n", i);
+            zclDiagnostics_SensorError(DIAGNOSTICS_SENSOR_DS18B20, 0);
+            continue;
+        }
+        LREP("ReadDS18B20 probe %d t=%d\r\n", i, zclProbes_Values[i]);
+        zclReporter_Mark(zclApp_SecondEP.EndPoint, TEMP, ATTRID_MS_TEMPERATURE_DS18B20_PROBE_VALUE + i);
+        if (i == 0) {
+            zclApp_DS18B20_MeasuredValue = zclProbes_Values[i];
+            zclReporter_Mark(zclApp_SecondEP.EndPoint, TEMP, ATTRID_MS_TEMPERATURE_MEASURED_VALUE);
+        }
+    }
+    return 0;
+}
+#endif
+
+#if APP_SENSOR_ILLUMINANCE
 static void zclApp_ReadLumosity(void) {
-    zclApp_IlluminanceSensor_MeasuredValueRawAdc = adcReadSampled(LUMOISITY_PIN, HAL_ADC_RESOLUTION_14, HAL_ADC_REF_AVDD, 5);
-    zclApp_IlluminanceSensor_MeasuredValue = zclApp_IlluminanceSensor_MeasuredValueRawAdc;
-    bdb_RepChangedAttrValue(zclApp_FirstEP.EndPoint, ILLUMINANCE, ATTRID_MS_ILLUMINANCE_MEASURED_VALUE);
-    LREP("IlluminanceSensor_MeasuredValue value=%d\r\n", zclApp_IlluminanceSensor_MeasuredValue);
+    uint16 raw = adcSequence_Result(LUMOISITY_PIN);
+    uint16 referenceMv = adcReferenceMv;
+    uint8 samples = adcSequence_Samples(LUMOISITY_PIN);
+    // FYI: no extra samples in light, only dark readings are worth one more short sequence
+    if ((uint32)raw * referenceMv < (uint32)APP_LIGHT_LOW_RANGE_MV * CONVERSION_ADC_FULL_SCALE &&
+        adcSequence_Start(BV(LUMOISITY_PIN), HAL_ADC_RESOLUTION_14, HAL_ADC_REF_125V, APP_ADC_SAMPLES) && zclApp_WaitADC()) {
+        raw = adcSequence_Result(LUMOISITY_PIN);
+        referenceMv = APP_ADC_INTERNAL_REF_MV;
+        samples += adcSequence_Samples(LUMOISITY_PIN);
+    }
+    zclApp_IlluminanceSensor_MeasuredValueRawAdc = raw;
+    zclApp_IlluminanceSensor_Samples = samples;
+    zclApp_IlluminanceSensor_MeasuredValue = convertIlluminance(raw, referenceMv);
+    zclReporter_Mark(zclApp_FirstEP.EndPoint, ILLUMINANCE, ATTRID_MS_ILLUMINANCE_MEASURED_VALUE);
+    LREP("IlluminanceSensor_MeasuredValue raw=%d ref=%d samples=%d value=%d\r\n", raw, referenceMv, samples,
+         zclApp_IlluminanceSensor_MeasuredValue);
 }
+#endif
 
-void user_delay_ms(uint32_t period) { MicroWait(period * 1000); }
+#if APP_SENSOR_BME280
+/**
+ * FYI: only soft reset in bme280_init waits here, once per boot, readings are timed by OSAL timers and status polling.
+ * Sleep timer keeps real time, while MicroWait is stretched by every interrupt served meanwhile
+ * */
+void user_delay_ms(uint32_t period) {
+    uint32 start = zclEnergy_Ticks();
+    while (zclEnergy_TicksToMs(ENERGY_TICKS_DIFF(zclEnergy_Ticks(), start)) < period) {
+    }
+}
+
+static uint16 zclApp_BME280MeasurementTime(const struct bme280_settings *settings, bool maximum) {
+    uint32 perOsr = maximum ? BME280_MEAS_TIME_MAX_PER_OSR_US : BME280_MEAS_TIME_PER_OSR_US;
+    uint32 setup = maximum ? BME280_MEAS_TIME_MAX_SETUP_US : BME280_MEAS_TIME_SETUP_US;
+    uint32 time = (maximum ? BME280_MEAS_TIME_MAX_BASE_US : BME280_MEAS_TIME_BASE_US) + perOsr * BME280_OSR_MULTIPLIER(settings->osr_t);
+    if (settings->osr_p != BME280_NO_OVERSAMPLING) {
+        time += perOsr * BME280_OSR_MULTIPLIER(settings->osr_p) + setup;
+    }
+    if (settings->osr_h != BME280_NO_OVERSAMPLING) {
+        time += perOsr * BME280_OSR_MULTIPLIER(settings->osr_h) + setup;
+    }
+    return (uint16)((time + 999) / 1000);
+}
 
-static void zclApp_InitBME280(struct bme280_dev *dev) {
-    int8_t rslt = bme280_init(dev);
+static uint16 zclApp_StartBME280(void) {
+    struct bme280_dev *dev = &bme_dev;
+    int8_t rslt = BME280_OK;
+    /**
+     * FYI: sensor is power cycled every reading, but calibration data in it's NVM never changes,
+     * so read it only once per boot
+     * */
+    if (!bme280Calibrated) {
+        rslt = bme280_init(dev);
+        bme280Calibrated = (rslt == BME280_OK);
+    }
     if (rslt == BME280_OK) {
         uint8_t settings_sel;
+        bool saving = zclPower_Level != POWER_LEVEL_NORMAL;
         dev->settings.osr_h = BME280_OVERSAMPLING_1X;
-        dev->settings.osr_p = BME280_OVERSAMPLING_16X;
-        dev->settings.osr_t = BME280_OVERSAMPLING_2X;
-        dev->settings.filter = BME280_FILTER_COEFF_16;
-        dev->settings.standby_time = BME280_STANDBY_TIME_62_5_MS;
+        // noisier pressure on low battery, measurement is 5 times shorter
+        dev->settings.osr_p = saving ? BME280_OVERSAMPLING_1X : BME280_OVERSAMPLING_16X;
+        dev->settings.osr_t = saving ? BME280_OVERSAMPLING_1X : BME280_OVERSAMPLING_2X;
+        // IIR filter can't settle on a single forced measurement
+        dev->settings.filter = BME280_FILTER_COEFF_OFF;
 
         settings_sel = BME280_OSR_PRESS_SEL;
         settings_sel |= BME280_OSR_TEMP_SEL;
         settings_sel |= BME280_OSR_HUM_SEL;
-        settings_sel |= BME280_STANDBY_SEL;
         settings_sel |= BME280_FILTER_SEL;
         rslt = bme280_set_sensor_settings(settings_sel, dev);
-        rslt = bme280_set_sensor_mode(BME280_NORMAL_MODE, dev);
-    } else {
-        LREP("ReadBME280 init error %d\r\n", rslt);
     }
+    if (rslt == BME280_OK) {
+        rslt = bme280_set_sensor_mode(BME280_FORCED_MODE, dev);
+    }
+    if (rslt != BME280_OK) {
+        LREP("StartBME280 error %d\r\n", rslt);
+        zclDiagnostics_SensorError(DIAGNOSTICS_SENSOR_BME280, rslt);
+        bme280Calibrated = FALSE;
+        return 0;
+    }
+    uint16 typical = zclApp_BME280MeasurementTime(&dev->settings, FALSE);
+    bme280PollsLeft = (zclApp_BME280MeasurementTime(&dev->settings, TRUE) - typical) / APP_BME280_POLL_INTERVAL + 1;
+    return typical;
 }
-static void zclApp_ReadBME280(struct bme280_dev *dev) {
-    int8_t rslt = bme280_get_sensor_data(BME280_ALL, &bme_results, dev);
+static uint16 zclApp_ReadBME280(void) {
+    uint8 status = 0;
+    int8_t rslt = bme280_get_regs(BME280_STATUS_REG_ADDR, &status, 1, &bme_dev);
+    if (rslt == BME280_OK && (status & BME280_STATUS_MEASURING)) {
+        if (bme280PollsLeft > 0) {
+            bme280PollsLeft--;
+            return APP_BME280_POLL_INTERVAL;
+        }
+        rslt = APP_BME280_E_TIMEOUT;
+    }
+    if (rslt == BME280_OK) {
+        // single burst of all data registers, 0xF7..0xFE
+        rslt = bme280_get_sensor_data(BME280_ALL, &bme_results, &bme_dev);
+    }
     if (rslt == BME280_OK) {
         zclApp_Temperature_Sensor_MeasuredValue = (int16)bme_results.temperature;
-        zclApp_PressureSensor_ScaledValue = (int16) (pow(10.0, (double) zclApp_PressureSensor_Scale) * (double) bme_results.pressure);
+        zclApp_PressureSensor_ScaledValue = scalePressure(bme_results.pressure, zclApp_PressureSensor_Scale);
         zclApp_PressureSensor_MeasuredValue = bme_results.pressure / 100;
         LREP("ReadBME280 t=%ld, p=%ld h=%ld\r\n", bme_results.temperature, bme_results.pressure, bme_results.humidity);
-        zclApp_HumiditySensor_MeasuredValue = (uint16)(bme_results.humidity * 100 / 1024);
-        bdb_RepChangedAttrValue(zclApp_FirstEP.EndPoint, TEMP, ATTRID_MS_TEMPERATURE_MEASURED_VALUE);
-        bdb_RepChangedAttrValue(zclApp_FirstEP.EndPoint, PRESSURE, ATTRID_MS_PRESSURE_MEASUREMENT_MEASURED_VALUE);
-        bdb_RepChangedAttrValue(zclApp_FirstEP.EndPoint, HUMIDITY, ATTRID_MS_RELATIVE_HUMIDITY_MEASURED_VALUE);
+        zclApp_HumiditySensor_MeasuredValue = convertHumidity(bme_results.humidity);
+        zclReporter_Mark(zclApp_FirstEP.EndPoint, TEMP, ATTRID_MS_TEMPERATURE_MEASURED_VALUE);
+        zclReporter_Mark(zclApp_FirstEP.EndPoint, PRESSURE, ATTRID_MS_PRESSURE_MEASUREMENT_MEASURED_VALUE);
+        zclReporter_Mark(zclApp_FirstEP.EndPoint, PRESSURE, ATTRID_MS_PRESSURE_MEASUREMENT_SCALED_VALUE);
+        zclReporter_Mark(zclApp_FirstEP.EndPoint, HUMIDITY, ATTRID_MS_RELATIVE_HUMIDITY_MEASURED_VALUE);
     } else {
         LREP("ReadBME280 read error %d\r\n", rslt);
+        zclDiagnostics_SensorError(DIAGNOSTICS_SENSOR_BME280, rslt);
+        bme280Calibrated = FALSE;
+    }
+    return 0;
+}
+#endif
+
+#define APP_TRACK(endpoint, cluster, attrId, threshold) zclReporter_Track(endpoint, cluster, attrId, threshold);
+#define APP_TRACK_SOIL_EXTRA(index, pin) APP_SOIL_EXTRA_TRACKED(APP_TRACK, index)
+static void zclApp_InitReporter(void) {
+    zclReporter_Init(&zclApp_Config.ReportHeartbeat);
+    APP_SENSORS_TRACKED(APP_TRACK)
+#if APP_SENSOR_SOIL
+    SOIL_MOISTURE_EXTRA_CHANNELS(APP_TRACK_SOIL_EXTRA)
+#endif
+}
+
+static void zclApp_ApplyReportInterval(void) {
+    uint16 interval = zclApp_Config.ReportInterval;
+    if (zclApp_Config.AdaptiveInterval && currentReportInterval != 0) {
+        // keep adapted value, but respect new bounds
+        interval = MAX(currentReportInterval, zclApp_Config.ReportIntervalMin);
+        interval = MIN(interval, MAX(zclApp_Config.ReportIntervalMin, zclApp_Config.ReportIntervalMax));
+    }
+    zclApp_SetReportInterval(interval);
+}
+
+static void zclApp_SetReportInterval(uint16 interval) {
+    if (interval == currentReportInterval && zclPower_Level == currentPowerLevel) {
+        return;
+    }
+    currentReportInterval = interval;
+    currentPowerLevel = zclPower_Level;
+    LREP("ReportInterval=%ds powerLevel=%d\r\n", currentReportInterval, currentPowerLevel);
+    osal_start_reload_timer(zclApp_TaskID, APP_REPORT_EVT, ((uint32)currentReportInterval << currentPowerLevel) * 1000);
+}
+
+static uint32 zclApp_RatePerHour(int32 delta, uint32 elapsedSeconds) {
+    if (delta < 0) {
+        delta = -delta;
+    }
+    return (uint32)delta * 3600 / MAX(elapsedSeconds, 1);
+}
+
+static void zclApp_AdaptReportInterval(void) {
+    uint32 now = osal_GetSystemClock();
+    uint32 elapsedSeconds = (now - adaptivePreviousTime) / 1000;
+    bool hasPrevious = adaptiveHasPrevious;
+
+    adaptiveHasPrevious = TRUE;
+    adaptivePreviousTime = now;
+    int32 soilDelta = (int32)zclApp_SoilHumiditySensor_MeasuredValue[0] - adaptivePreviousSoilHumidity;
+    int32 temperatureDelta = (int32)zclApp_Temperature_Sensor_MeasuredValue - adaptivePreviousTemperature;
+    adaptivePreviousSoilHumidity = zclApp_SoilHumiditySensor_MeasuredValue[0];
+    adaptivePreviousTemperature = zclApp_Temperature_Sensor_MeasuredValue;
+
+    if (!zclApp_Config.AdaptiveInterval || !hasPrevious) {
+        return;
+    }
+
+    uint32 soilRate = zclApp_RatePerHour(soilDelta, elapsedSeconds);
+    uint32 temperatureRate = zclApp_RatePerHour(temperatureDelta, elapsedSeconds);
+    LREP("Adaptive soilRate=%ld temperatureRate=%ld\r\n", soilRate, temperatureRate);
+
+    uint16 interval = currentReportInterval;
+    if (soilRate >= APP_ADAPTIVE_SOIL_HUMIDITY_FAST_RATE || temperatureRate >= APP_ADAPTIVE_TEMPERATURE_FAST_RATE) {
+        interval = zclApp_Config.ReportIntervalMin;
+    } else if (soilRate < APP_ADAPTIVE_SOIL_HUMIDITY_FLAT_RATE && temperatureRate < APP_ADAPTIVE_TEMPERATURE_FLAT_RATE) {
+        interval = (uint16)MIN((uint32)interval * 2, MAX(zclApp_Config.ReportIntervalMin, zclApp_Config.ReportIntervalMax));
+    }
+    zclApp_SetReportInterval(interval);
+}
+
+static void zclApp_LoadConfig(void) {
+    uint16 len = osal_nv_item_len(NW_APP_CONFIG);
+    if (len != 0 && len != sizeof(application_config_t)) {
+        // config layout was changed by firmware update, start over with defaults
+        osal_nv_delete(NW_APP_CONFIG, len);
+    }
+    if (osal_nv_item_init(NW_APP_CONFIG, sizeof(application_config_t), &zclApp_Config) == SUCCESS) {
+        osal_nv_read(NW_APP_CONFIG, 0, sizeof(application_config_t), &zclApp_Config);
+    }
+    LREP("LoadConfig DS18B20Resolution=%d ReportHeartbeat=%d\r\n", zclApp_Config.DS18B20Resolution, zclApp_Config.ReportHeartbeat);
+}
+
+static void zclApp_SaveAttributesToNV(void) {
+    uint8 writeStatus = osal_nv_write(NW_APP_CONFIG, 0, sizeof(application_config_t), &zclApp_Config);
+    LREP("Saving attributes to NV write=%d\r\n", writeStatus);
+}
+
+static uint8 zclApp_ReadWriteAuthCB(afAddrType_t *srcAddr, zclAttrRec_t *pAttr, uint8 oper) {
+    if (oper == ZCL_OPER_WRITE) {
+        // value is written after this callback returns, so save it a bit later
+        osal_start_timerEx(zclApp_TaskID, APP_SAVE_ATTRS_EVT, APP_SAVE_ATTRS_DELAY);
+        zclPoll_Fast(APP_POLL_EXCHANGE_WINDOW);
+    }
+    return ZCL_STATUS_SUCCESS;
+}
+
+static ZStatus_t zclApp_ReadWriteCB(uint16 clusterId, uint16 attrId, uint8 oper, uint8 *pValue, uint16 *pLen) {
+    // only attributes without data pointer get here
+    if (clusterId == DIAGNOSTICS && attrId >= ATTRID_DIAGNOSTICS_TRACE_PAGE && attrId < ATTRID_DIAGNOSTICS_TRACE_PAGE + TRACE_PAGES) {
+        return zclTrace_ReadPage((uint8)(attrId - ATTRID_DIAGNOSTICS_TRACE_PAGE), oper, pValue, pLen);
+    }
+#if APP_SENSOR_DS18B20
+    if (clusterId == TEMP && attrId >= ATTRID_MS_TEMPERATURE_DS18B20_PROBE_ROM && attrId < ATTRID_MS_TEMPERATURE_DS18B20_PROBE_ROM + PROBES_MAX) {
+        return zclProbes_ReadRom((uint8)(attrId - ATTRID_MS_TEMPERATURE_DS18B20_PROBE_ROM), oper, pValue, pLen);
+    }
+#endif
+    return ZCL_STATUS_SOFTWARE_FAILURE;
+}
+
+static uint8 zclApp_ValidateAttrData(zclAttrRec_t *pAttr, zclWriteRec_t *pAttrInfo) {
+    if (pAttr->clusterID == TEMP && pAttr->attr.attrId == ATTRID_MS_TEMPERATURE_DS18B20_RESOLUTION) {
+        uint8 resolution = *pAttrInfo->attrData;
+        return (resolution >= DS18B20_RESOLUTION_MIN && resolution <= DS18B20_RESOLUTION_MAX);
+    }
+    if (pAttr->clusterID == BASIC &&
+        (pAttr->attr.attrId == ATTRID_BASIC_REPORT_INTERVAL || pAttr->attr.attrId == ATTRID_BASIC_REPORT_INTERVAL_MIN ||
+         pAttr->attr.attrId == ATTRID_BASIC_REPORT_INTERVAL_MAX)) {
+        return BUILD_UINT16(pAttrInfo->attrData[0], pAttrInfo->attrData[1]) >= APP_REPORT_INTERVAL_MIN;
+    }
+    if (pAttr->clusterID == SOIL_HUMIDITY && pAttr->attr.attrId == ATTRID_SOIL_EXCITATION_SETTLE) {
+        uint16 settle = BUILD_UINT16(pAttrInfo->attrData[0], pAttrInfo->attrData[1]);
+        return (settle >= APP_SOIL_EXCITATION_SETTLE_MIN && settle <= APP_SOIL_EXCITATION_SETTLE_MAX);
+    }
+    if (pAttr->clusterID == SOIL_HUMIDITY && pAttr->attr.attrId == ATTRID_SOIL_EXCITATION_PERIOD) {
+        return *pAttrInfo->attrData != 0;
+    }
+    if (pAttr->clusterID == POWER_CFG && pAttr->attr.attrId == ATTRID_POWER_CFG_BATTERY_CHEMISTRY) {
+        return *pAttrInfo->attrData < POWER_CHEMISTRY_COUNT;
+    }
+    if (pAttr->clusterID == POLL_CONTROL) {
+        return zclPollCtrl_ValidateAttr(pAttr->attr.attrId, pAttrInfo->attrData);
+    }
+    return TRUE;
+}
+
+static void zclApp_Report(void) {
+    // restarting timer would postpone results already due
+    if (!acquisitionRunning) {
+        osal_start_timerEx(zclApp_TaskID, APP_READ_SENSORS_EVT, APP_READ_SENSORS_DELAY);
+    }
+}
+
+static ZStatus_t zclApp_HandleFlowerCtrl(zclIncoming_t *pInMsg) {
+    if (!pInMsg->hdr.fc.clusterSpecific || pInMsg->hdr.fc.direction != ZCL_FRAME_CLIENT_SERVER_DIR ||
+        pInMsg->hdr.commandID != COMMAND_FLOWER_CTRL_READ_NOW) {
+        return ZFailure;
     }
+    LREPMaster("Read now\r\n");
+    // caller waits for fresh values, so report them even when they didn't move past thresholds
+    zclReporter_ForceNext();
+    zclPoll_Fast(APP_POLL_EXCHANGE_WINDOW);
+    zclApp_Report();
+    return ZSuccess;
 }
-static void zclApp_Report(void) { osal_start_reload_timer(zclApp_TaskID, APP_READ_SENSORS_EVT, 100); }
 
 /****************************************************************************
 ****************************************************************************/
@@ -8,6 +8,7 @@ extern "C" {
 /*********************************************************************
  * INCLUDES
  */
+#include "sensors.h"
 #include "version.h"
 #include "zcl.h"
 
@@ -19,16 +20,34 @@ extern "C" {
 // Application Events
 #define APP_REPORT_EVT                  0x0001
 #define APP_READ_SENSORS_EVT            0x0002
+#define APP_SAVE_ATTRS_EVT              0x0004
+#define APP_HISTORY_EVT                 0x0008
+#define APP_POLL_EVT                    0x0010
+#define APP_REJOIN_EVT                  0x0020
+#define APP_CHECK_IN_EVT                0x0040
 
+#define NW_APP_CONFIG                   0x0402
+#define NW_APP_HISTORY                  0x0403
+#define NW_APP_DIAGNOSTICS              0x0404
+#define NW_APP_PROBES                   0x0405
 
 
 
-#define AIR_COMPENSATION_FORMULA(ADC)   ((0.179 * (double)ADC + 3926.0))
-#define WATER_COMPENSATION_FORMULA(ADC) ((0.146 * (double)ADC + 2020.0))
 
+#define APP_REPORT_INTERVAL_MIN         30 // seconds, lower bound for writable intervals
 
+#define APP_SOIL_EXCITATION_SETTLE_MIN  1    // ms
+#define APP_SOIL_EXCITATION_SETTLE_MAX  5000 // ms
 
-#define APP_REPORT_DELAY ((uint32) 1800000) //30 minutes
+/**
+ * FYI: adaptive interval drops to ReportIntervalMin when soil humidity or temperature change faster
+ * than *_FAST_RATE and doubles up to ReportIntervalMax while both change slower than *_FLAT_RATE,
+ * rates are in attribute units per hour
+ * */
+#define APP_ADAPTIVE_SOIL_HUMIDITY_FAST_RATE 500 // 5 %/h
+#define APP_ADAPTIVE_SOIL_HUMIDITY_FLAT_RATE 100 // 1 %/h
+#define APP_ADAPTIVE_TEMPERATURE_FAST_RATE   200 // 2 C/h
+#define APP_ADAPTIVE_TEMPERATURE_FLAT_RATE   50  // 0.5 C/h
 
 
 /*********************************************************************
@@ -37,6 +56,7 @@ extern "C" {
 
 #define R           ACCESS_CONTROL_READ
 #define RR          (R | ACCESS_REPORTABLE)
+#define RW          (R | ACCESS_CONTROL_WRITE | ACCESS_CONTROL_AUTH_WRITE)
 
 #define BASIC       ZCL_CLUSTER_ID_GEN_BASIC
 #define POWER_CFG   ZCL_CLUSTER_ID_GEN_POWER_CFG
@@ -45,6 +65,8 @@ extern "C" {
 #define SOIL_HUMIDITY                  0x0408
 #define PRESSURE    ZCL_CLUSTER_ID_MS_PRESSURE_MEASUREMENT
 #define ILLUMINANCE ZCL_CLUSTER_ID_MS_ILLUMINANCE_MEASUREMENT
+#define FLOWER_CTRL                    0xFC01
+#define DIAGNOSTICS ZCL_CLUSTER_ID_HA_DIAGNOSTIC
 
 #define ZCL_UINT8   ZCL_DATATYPE_UINT8
 #define ZCL_UINT16  ZCL_DATATYPE_UINT16
@@ -56,18 +78,105 @@ extern "C" {
 #define ATTRID_MS_RELATIVE_HUMIDITY_MEASURED_VALUE_RAW_ADC              0x0200
 #define ATTRID_MS_RELATIVE_HUMIDITY_MEASURED_VALUE_BATTERY_RAW_ADC      0x0201
 
+#define ATTRID_MS_TEMPERATURE_DS18B20_RESOLUTION                        0x0200
+#define ATTRID_MS_TEMPERATURE_DS18B20_PROBES_COUNT                      0x0201
+// first of APP_DS18B20_PROBES_MAX attributes, see sensors.h
+#define ATTRID_MS_TEMPERATURE_DS18B20_PROBE_VALUE                       0x0220
+#define ATTRID_MS_TEMPERATURE_DS18B20_PROBE_ROM                         0x0230
+
+#define ATTRID_SOIL_EXCITATION_SETTLE                                   0x0211
+#define ATTRID_SOIL_EXCITATION_PERIOD                                   0x0212
+#define ATTRID_SOIL_CALIBRATION_AIR                                     0x0213
+#define ATTRID_SOIL_CALIBRATION_WATER                                   0x0214
+
+// ADC samples behind last value, same id in every cluster measured by ADC sequence
+#define ATTRID_ADC_SAMPLES                                              0x0215
+
+// see power.h
+#define ATTRID_POWER_CFG_BATTERY_CHEMISTRY                              0x0211
+#define ATTRID_POWER_CFG_POWER_LEVEL                                    0x0212
+#define ATTRID_POWER_CFG_COMPENSATED_VOLTAGE                            0x0213
+
+// reportable change of cluster's main attribute, same id in every measurement cluster
+#define ATTRID_REPORT_THRESHOLD                                         0x0210
+#define ATTRID_BASIC_REPORT_HEARTBEAT                                   0x0210
+#define ATTRID_BASIC_REPORT_INTERVAL                                    0x0211
+#define ATTRID_BASIC_ADAPTIVE_INTERVAL                                  0x0212
+#define ATTRID_BASIC_REPORT_INTERVAL_MIN                                0x0213
+#define ATTRID_BASIC_REPORT_INTERVAL_MAX                                0x0214
+#define ATTRID_BASIC_POLL_RATE                                          0x0220
+#define ATTRID_BASIC_POLL_FAST_TIME                                     0x0221
+#define ATTRID_BASIC_POLL_IDLE_TIME                                     0x0222
+#define ATTRID_BASIC_POLL_FAST_WINDOWS                                  0x0223
+
+#define ATTRID_DIAGNOSTICS_WAKE_UPS                                     0x0200
+#define ATTRID_DIAGNOSTICS_AWAKE_TIME                                   0x0201
+#define ATTRID_DIAGNOSTICS_HOLD_TIME                                    0x0202
+#define ATTRID_DIAGNOSTICS_FRAMES_SENT                                  0x0203
+#define ATTRID_DIAGNOSTICS_TX_FAILURES                                  0x0204
+#define ATTRID_DIAGNOSTICS_REJOINS                                      0x0205
+#define ATTRID_DIAGNOSTICS_BME280_ERRORS                                0x0206
+#define ATTRID_DIAGNOSTICS_BME280_LAST_ERROR                            0x0207
+#define ATTRID_DIAGNOSTICS_DS18B20_ERRORS                               0x0208
+#define ATTRID_DIAGNOSTICS_LAST_CYCLE_TIME                              0x0209
+#define ATTRID_DIAGNOSTICS_BOOT_REPORT_TIME                             0x020A
+#define ATTRID_DIAGNOSTICS_REJOIN_ATTEMPTS                              0x020B
+#define ATTRID_DIAGNOSTICS_REJOIN_SCANS                                 0x020C
+#define ATTRID_DIAGNOSTICS_REJOIN_RADIO_TIME                            0x020D
+#define ATTRID_DIAGNOSTICS_REJOIN_LAST_TIME                             0x020E
+// first of TRACE_PAGES octet string attributes, see trace.h
+#define ATTRID_DIAGNOSTICS_TRACE_PAGE                                   0x0210
+
+// server to client, payload: clock uint32, count uint8, zclHistory_Record_t[count]
+#define COMMAND_FLOWER_CTRL_HISTORY                                     0x00
+// client to server, no payload: sensors are read right away and all values are reported
+#define COMMAND_FLOWER_CTRL_READ_NOW                                    0x00
+
 
 
 /*********************************************************************
  * TYPEDEFS
  */
 
+// raw ADC offsets added to compensated air and water levels of soil channel
+typedef struct {
+    int16 AirOffset;
+    int16 WaterOffset;
+} zclApp_SoilCalibration_t;
+
+typedef struct {
+    uint8 DS18B20Resolution;
+    uint16 ReportHeartbeat; // seconds, 0 - report only on change
+    uint16 ReportInterval;  // seconds
+    bool AdaptiveInterval;
+    uint16 ReportIntervalMin; // seconds, adaptive mode bounds
+    uint16 ReportIntervalMax;
+    uint16 SoilExcitationSettle; // ms from excitation start till soil is sampled
+    uint8 SoilExcitationPeriod;  // timer 3 ticks, T3CC0
+    uint16 TemperatureThreshold;
+    uint16 HumidityThreshold;
+    uint16 PressureThreshold;
+    uint16 IlluminanceThreshold;
+    uint16 SoilHumidityThreshold;
+    uint16 BatteryVoltageThreshold;
+    uint16 DS18B20Threshold;
+    uint8 BatteryChemistry; // selects discharge curve, POWER_CHEMISTRY_*
+    uint32 PollCheckInInterval; // quarter seconds, Poll Control cluster, 0 - no check-in
+    uint32 PollLongInterval;
+    uint16 PollShortInterval;
+    uint16 PollFastTimeout;
+    zclApp_SoilCalibration_t SoilCalibration[APP_SOIL_CHANNELS];
+} application_config_t;
+
 /*********************************************************************
  * VARIABLES
  */
 
 extern SimpleDescriptionFormat_t zclApp_FirstEP;
 extern SimpleDescriptionFormat_t zclApp_SecondEP;
+#if APP_SOIL_EXTRA_CHANNELS > 0
+extern SimpleDescriptionFormat_t zclApp_SoilEPs[APP_SOIL_EXTRA_CHANNELS];
+#endif
 
 extern uint8 zclApp_BatteryVoltage;
 extern uint8 zclApp_BatteryPercentageRemainig;
@@ -78,16 +187,23 @@ extern int16 zclApp_PressureSensor_ScaledValue;
 extern int8 zclApp_PressureSensor_Scale;
 extern uint16 zclApp_HumiditySensor_MeasuredValue;
 extern int16 zclApp_DS18B20_MeasuredValue;
-extern uint16 zclApp_SoilHumiditySensor_MeasuredValue;
-extern uint16 zclApp_SoilHumiditySensor_MeasuredValueRawAdc;
+extern uint16 zclApp_SoilHumiditySensor_MeasuredValue[APP_SOIL_CHANNELS];
+extern uint16 zclApp_SoilHumiditySensor_MeasuredValueRawAdc[APP_SOIL_CHANNELS];
+extern uint8 zclApp_SoilHumiditySensor_Samples[APP_SOIL_CHANNELS];
 extern uint16 zclApp_IlluminanceSensor_MeasuredValue;
 extern uint16 zclApp_IlluminanceSensor_MeasuredValueRawAdc;
+extern uint8 zclApp_IlluminanceSensor_Samples;
+
+extern application_config_t zclApp_Config;
 
 // attribute list
 extern CONST zclAttrRec_t zclApp_AttrsFirstEP[];
 extern CONST zclAttrRec_t zclApp_AttrsSecondEP[];
 extern CONST uint8 zclApp_AttrsSecondEPCount;
 extern CONST uint8 zclApp_AttrsFirstEPCount;
+#if APP_SOIL_EXTRA_CHANNELS > 0
+extern CONST zclAttrRec_t zclApp_AttrsSoilEPs[APP_SOIL_EXTRA_CHANNELS][APP_SOIL_EP_ATTRS_COUNT];
+#endif
 
 
 extern const uint8 zclApp_ManufacturerName[];
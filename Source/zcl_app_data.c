@@ -11,6 +11,13 @@
 #include "zcl_app.h"
 
 #include "battery.h"
+#include "diagnostics.h"
+#include "poll.h"
+#include "pollctrl.h"
+#include "power.h"
+#include "probes.h"
+#include "rejoin.h"
+#include "sensors.h"
 #include "version.h"
 /*********************************************************************
  * CONSTANTS
@@ -22,6 +29,33 @@
 #define APP_HWVERSION 1
 #define APP_ZCLVERSION 1
 
+#define DEFAULT_DS18B20_RESOLUTION 12
+
+#define DEFAULT_REPORT_INTERVAL 1800      // 30 minutes
+
+// previous fixed phase delay, calibration formulas were made with it
+#define DEFAULT_SOIL_EXCITATION_SETTLE 100
+#define DEFAULT_SOIL_EXCITATION_PERIOD 4
+#define DEFAULT_REPORT_INTERVAL_MIN 300   // 5 minutes
+#define DEFAULT_REPORT_INTERVAL_MAX 14400 // 4 hours
+
+// thresholds are in units of reported attribute
+#define DEFAULT_REPORT_HEARTBEAT 14400        // 4 hours
+#define DEFAULT_TEMPERATURE_THRESHOLD 50      // 0.5 C
+#define DEFAULT_HUMIDITY_THRESHOLD 200        // 2 %
+#define DEFAULT_PRESSURE_THRESHOLD 1          // 1 hPa
+#define DEFAULT_ILLUMINANCE_THRESHOLD 500     // 10000 * log10(lux), ~12% change
+#define DEFAULT_SOIL_HUMIDITY_THRESHOLD 200   // 2 %
+#define DEFAULT_BATTERY_VOLTAGE_THRESHOLD 1   // 0.1 V
+
+#define DEFAULT_BATTERY_CHEMISTRY POWER_CHEMISTRY_ALKALINE_2AA
+
+// quarter seconds
+#define DEFAULT_POLL_CHECK_IN_INTERVAL 14400 // 1 hour
+#define DEFAULT_POLL_LONG_INTERVAL (POLL_IDLE_RATE / 250)
+#define DEFAULT_POLL_SHORT_INTERVAL (POLL_FAST_RATE / 250)
+#define DEFAULT_POLL_FAST_TIMEOUT 40 // 10 seconds
+
 /*********************************************************************
  * TYPEDEFS
  */
@@ -44,13 +78,36 @@ int8 zclApp_PressureSensor_Scale = -1;
 
 uint16 zclApp_HumiditySensor_MeasuredValue = 0;
 
-uint16 zclApp_SoilHumiditySensor_MeasuredValue = 0;
-uint16 zclApp_SoilHumiditySensor_MeasuredValueRawAdc = 0;
+uint16 zclApp_SoilHumiditySensor_MeasuredValue[APP_SOIL_CHANNELS];
+uint16 zclApp_SoilHumiditySensor_MeasuredValueRawAdc[APP_SOIL_CHANNELS];
+uint8 zclApp_SoilHumiditySensor_Samples[APP_SOIL_CHANNELS];
 
 int16 zclApp_DS18B20_MeasuredValue = 0;
 
 uint16 zclApp_IlluminanceSensor_MeasuredValue = 0;
 uint16 zclApp_IlluminanceSensor_MeasuredValueRawAdc = 0;
+uint8 zclApp_IlluminanceSensor_Samples = 0;
+
+application_config_t zclApp_Config = {.DS18B20Resolution = DEFAULT_DS18B20_RESOLUTION,
+                                      .ReportHeartbeat = DEFAULT_REPORT_HEARTBEAT,
+                                      .ReportInterval = DEFAULT_REPORT_INTERVAL,
+                                      .AdaptiveInterval = FALSE,
+                                      .ReportIntervalMin = DEFAULT_REPORT_INTERVAL_MIN,
+                                      .ReportIntervalMax = DEFAULT_REPORT_INTERVAL_MAX,
+                                      .SoilExcitationSettle = DEFAULT_SOIL_EXCITATION_SETTLE,
+                                      .SoilExcitationPeriod = DEFAULT_SOIL_EXCITATION_PERIOD,
+                                      .TemperatureThreshold = DEFAULT_TEMPERATURE_THRESHOLD,
+                                      .HumidityThreshold = DEFAULT_HUMIDITY_THRESHOLD,
+                                      .PressureThreshold = DEFAULT_PRESSURE_THRESHOLD,
+                                      .IlluminanceThreshold = DEFAULT_ILLUMINANCE_THRESHOLD,
+                                      .SoilHumidityThreshold = DEFAULT_SOIL_HUMIDITY_THRESHOLD,
+                                      .BatteryVoltageThreshold = DEFAULT_BATTERY_VOLTAGE_THRESHOLD,
+                                      .DS18B20Threshold = DEFAULT_TEMPERATURE_THRESHOLD,
+                                      .BatteryChemistry = DEFAULT_BATTERY_CHEMISTRY,
+                                      .PollCheckInInterval = DEFAULT_POLL_CHECK_IN_INTERVAL,
+                                      .PollLongInterval = DEFAULT_POLL_LONG_INTERVAL,
+                                      .PollShortInterval = DEFAULT_POLL_SHORT_INTERVAL,
+                                      .PollFastTimeout = DEFAULT_POLL_FAST_TIMEOUT};
 
 // Basic Cluster
 const uint8 zclApp_HWRevision = APP_HWVERSION;
@@ -78,6 +135,9 @@ const uint8 zclApp_PowerSource = POWER_SOURCE_BATTERY;
 // #define ZCL_CLUSTER_ID_MS_TEMPERATURE_MEASUREMENT            0x0402
 // #define ZCL_CLUSTER_ID_MS_PRESSURE_MEASUREMENT               0x0403
 
+#define APP_ATTR_RECORD(cluster, attrId, dataType, accessControl, dataPtr) {cluster, {attrId, dataType, accessControl, (void *)(dataPtr)}},
+#define APP_CLUSTER_ID(cluster) cluster,
+
 CONST zclAttrRec_t zclApp_AttrsFirstEP[] = {
     {BASIC, {ATTRID_BASIC_APPL_VERSION, ZCL_UINT8, R, (void *)&zclApp_ApplicationVersion}},
     {BASIC, {ATTRID_BASIC_STACK_VERSION, ZCL_UINT8, R, (void *)&zclApp_StackVersion}},
@@ -89,48 +149,75 @@ CONST zclAttrRec_t zclApp_AttrsFirstEP[] = {
     {BASIC, {ATTRID_CLUSTER_REVISION, ZCL_DATATYPE_UINT16, R, (void *)&zclApp_clusterRevision_all}},
     {BASIC, {ATTRID_BASIC_DATE_CODE, ZCL_DATATYPE_CHAR_STR, R, (void *)zclApp_DateCode}},
     {BASIC, {ATTRID_BASIC_SW_BUILD_ID, ZCL_DATATYPE_CHAR_STR, R, (void *)zclApp_DateCode}},
+    {BASIC, {ATTRID_BASIC_REPORT_HEARTBEAT, ZCL_UINT16, RW, (void *)&zclApp_Config.ReportHeartbeat}},
+    {BASIC, {ATTRID_BASIC_REPORT_INTERVAL, ZCL_UINT16, RW, (void *)&zclApp_Config.ReportInterval}},
+    {BASIC, {ATTRID_BASIC_ADAPTIVE_INTERVAL, ZCL_DATATYPE_BOOLEAN, RW, (void *)&zclApp_Config.AdaptiveInterval}},
+    {BASIC, {ATTRID_BASIC_REPORT_INTERVAL_MIN, ZCL_UINT16, RW, (void *)&zclApp_Config.ReportIntervalMin}},
+    {BASIC, {ATTRID_BASIC_REPORT_INTERVAL_MAX, ZCL_UINT16, RW, (void *)&zclApp_Config.ReportIntervalMax}},
+    {BASIC, {ATTRID_BASIC_POLL_RATE, ZCL_UINT32, R, (void *)&zclPoll_Stats.rate}},
+    {BASIC, {ATTRID_BASIC_POLL_FAST_TIME, ZCL_UINT32, R, (void *)&zclPoll_Stats.fastSeconds}},
+    {BASIC, {ATTRID_BASIC_POLL_IDLE_TIME, ZCL_UINT32, R, (void *)&zclPoll_Stats.idleSeconds}},
+    {BASIC, {ATTRID_BASIC_POLL_FAST_WINDOWS, ZCL_UINT16, R, (void *)&zclPoll_Stats.fastWindows}},
+    // long and short intervals are changed with commands, see pollctrl.c
+    {POLL_CONTROL, {ATTRID_POLL_CONTROL_CHECK_IN_INTERVAL, ZCL_UINT32, RW, (void *)&zclApp_Config.PollCheckInInterval}},
+    {POLL_CONTROL, {ATTRID_POLL_CONTROL_LONG_POLL_INTERVAL, ZCL_UINT32, R, (void *)&zclApp_Config.PollLongInterval}},
+    {POLL_CONTROL, {ATTRID_POLL_CONTROL_SHORT_POLL_INTERVAL, ZCL_UINT16, R, (void *)&zclApp_Config.PollShortInterval}},
+    {POLL_CONTROL, {ATTRID_POLL_CONTROL_FAST_POLL_TIMEOUT, ZCL_UINT16, RW, (void *)&zclApp_Config.PollFastTimeout}},
     {POWER_CFG, {ATTRID_POWER_CFG_BATTERY_VOLTAGE, ZCL_UINT8, RR, (void *)&zclBattery_Voltage}},
 /**
- * FYI: calculating battery percentage can be tricky, since this device can be powered from 2xAA or 1xCR2032 batteries
+ * FYI: device can be powered from 2xAA or 1xCR2032 batteries, percentage is only as good as
+ * BatteryChemistry attribute, it selects discharge curve in power.c
  * */
     {POWER_CFG, {ATTRID_POWER_CFG_BATTERY_PERCENTAGE_REMAINING, ZCL_UINT8, RR, (void *)&zclBattery_PercentageRemainig}},
     {POWER_CFG, {ATTRID_POWER_CFG_BATTERY_VOLTAGE_RAW_ADC, ZCL_UINT16, RR, (void *)&zclBattery_RawAdc}},
+    {POWER_CFG, {ATTRID_REPORT_THRESHOLD, ZCL_UINT16, RW, (void *)&zclApp_Config.BatteryVoltageThreshold}},
+    {POWER_CFG, {ATTRID_POWER_CFG_BATTERY_CHEMISTRY, ZCL_DATATYPE_ENUM8, RW, (void *)&zclApp_Config.BatteryChemistry}},
+    {POWER_CFG, {ATTRID_POWER_CFG_POWER_LEVEL, ZCL_UINT8, R, (void *)&zclPower_Level}},
+    {POWER_CFG, {ATTRID_POWER_CFG_COMPENSATED_VOLTAGE, ZCL_UINT16, R, (void *)&zclPower_CompensatedMv}},
 
 
-    {ILLUMINANCE, {ATTRID_MS_ILLUMINANCE_MEASURED_VALUE, ZCL_UINT16, RR, (void *)&zclApp_IlluminanceSensor_MeasuredValue}},
-    {TEMP, {ATTRID_MS_TEMPERATURE_MEASURED_VALUE, ZCL_INT16, RR, (void *)&zclApp_Temperature_Sensor_MeasuredValue}},
-
-    {PRESSURE, {ATTRID_MS_PRESSURE_MEASUREMENT_MEASURED_VALUE, ZCL_INT16, RR, (void *)&zclApp_PressureSensor_MeasuredValue}},
-    {PRESSURE, {ATTRID_MS_PRESSURE_MEASUREMENT_SCALED_VALUE, ZCL_INT16, RR, (void *)&zclApp_PressureSensor_ScaledValue}},
-    {PRESSURE, {ATTRID_MS_PRESSURE_MEASUREMENT_SCALE, ZCL_INT8, RR, (void *)&zclApp_PressureSensor_Scale}},
-
-    {HUMIDITY, {ATTRID_MS_RELATIVE_HUMIDITY_MEASURED_VALUE, ZCL_UINT16, RR, (void *)&zclApp_HumiditySensor_MeasuredValue}},
-
 /**
  * FYI: ATTRID_POWER_CFG_BATTERY_VOLTAGE_RAW_ADC and ATTRID_MS_RELATIVE_HUMIDITY_MEASURED_VALUE_RAW_ADC
  * can be used to calculate relative humidity in converter
 */
-    {SOIL_HUMIDITY, {ATTRID_MS_RELATIVE_HUMIDITY_MEASURED_VALUE, ZCL_UINT16, RR, (void *)&zclApp_SoilHumiditySensor_MeasuredValue}},
-    {SOIL_HUMIDITY, {ATTRID_MS_RELATIVE_HUMIDITY_MEASURED_VALUE_RAW_ADC, ZCL_UINT16, RR, (void *)&zclApp_SoilHumiditySensor_MeasuredValueRawAdc}},
-    {SOIL_HUMIDITY, {ATTRID_MS_RELATIVE_HUMIDITY_MEASURED_VALUE_BATTERY_RAW_ADC, ZCL_UINT16, RR, (void *)&zclBattery_RawAdc}}
+    APP_SENSORS_ATTRS_FIRST_EP(APP_ATTR_RECORD)
+
+    {DIAGNOSTICS, {ATTRID_DIAGNOSTICS_WAKE_UPS, ZCL_UINT32, R, (void *)&zclDiagnostics_Counters.wakeUps}},
+    {DIAGNOSTICS, {ATTRID_DIAGNOSTICS_AWAKE_TIME, ZCL_UINT32, R, (void *)&zclDiagnostics_Counters.awakeMs}},
+    {DIAGNOSTICS, {ATTRID_DIAGNOSTICS_HOLD_TIME, ZCL_UINT32, R, (void *)&zclDiagnostics_Counters.holdMs}},
+    {DIAGNOSTICS, {ATTRID_DIAGNOSTICS_FRAMES_SENT, ZCL_UINT32, R, (void *)&zclDiagnostics_Counters.framesSent}},
+    {DIAGNOSTICS, {ATTRID_DIAGNOSTICS_TX_FAILURES, ZCL_UINT32, R, (void *)&zclDiagnostics_Counters.txFailures}},
+    {DIAGNOSTICS, {ATTRID_DIAGNOSTICS_REJOINS, ZCL_UINT16, R, (void *)&zclDiagnostics_Counters.rejoins}},
+    {DIAGNOSTICS, {ATTRID_DIAGNOSTICS_BME280_ERRORS, ZCL_UINT16, R, (void *)&zclDiagnostics_Counters.bme280Errors}},
+    {DIAGNOSTICS, {ATTRID_DIAGNOSTICS_BME280_LAST_ERROR, ZCL_INT8, R, (void *)&zclDiagnostics_Counters.bme280LastError}},
+    {DIAGNOSTICS, {ATTRID_DIAGNOSTICS_DS18B20_ERRORS, ZCL_UINT16, R, (void *)&zclDiagnostics_Counters.ds18b20Errors}},
+    {DIAGNOSTICS, {ATTRID_DIAGNOSTICS_LAST_CYCLE_TIME, ZCL_UINT32, R, (void *)&zclDiagnostics_Counters.lastCycleMs}},
+    {DIAGNOSTICS, {ATTRID_DIAGNOSTICS_BOOT_REPORT_TIME, ZCL_UINT32, R, (void *)&zclDiagnostics_BootReportMs}},
+    {DIAGNOSTICS, {ATTRID_DIAGNOSTICS_REJOIN_ATTEMPTS, ZCL_UINT16, R, (void *)&zclRejoin_Stats.attempts}},
+    {DIAGNOSTICS, {ATTRID_DIAGNOSTICS_REJOIN_SCANS, ZCL_UINT16, R, (void *)&zclRejoin_Stats.scans}},
+    {DIAGNOSTICS, {ATTRID_DIAGNOSTICS_REJOIN_RADIO_TIME, ZCL_UINT32, R, (void *)&zclRejoin_Stats.radioMs}},
+    {DIAGNOSTICS, {ATTRID_DIAGNOSTICS_REJOIN_LAST_TIME, ZCL_UINT32, R, (void *)&zclRejoin_Stats.lastLossMs}},
+    // served by zclApp_ReadWriteCB
+    {DIAGNOSTICS, {ATTRID_DIAGNOSTICS_TRACE_PAGE + 0, ZCL_DATATYPE_OCTET_STR, R, NULL}},
+    {DIAGNOSTICS, {ATTRID_DIAGNOSTICS_TRACE_PAGE + 1, ZCL_DATATYPE_OCTET_STR, R, NULL}},
+    {DIAGNOSTICS, {ATTRID_DIAGNOSTICS_TRACE_PAGE + 2, ZCL_DATATYPE_OCTET_STR, R, NULL}},
+    {DIAGNOSTICS, {ATTRID_DIAGNOSTICS_TRACE_PAGE + 3, ZCL_DATATYPE_OCTET_STR, R, NULL}}
 };
 
 
-CONST zclAttrRec_t zclApp_AttrsSecondEP[] = {
-    {TEMP, {ATTRID_MS_TEMPERATURE_MEASURED_VALUE, ZCL_INT16, RR, (void *)&zclApp_DS18B20_MeasuredValue}},
-};
+#if APP_SENSOR_DS18B20
+CONST zclAttrRec_t zclApp_AttrsSecondEP[] = {APP_SENSORS_ATTRS_SECOND_EP(APP_ATTR_RECORD)};
 uint8 CONST zclApp_AttrsSecondEPCount = (sizeof(zclApp_AttrsSecondEP) / sizeof(zclApp_AttrsSecondEP[0]));
+#endif
 uint8 CONST zclApp_AttrsFirstEPCount = (sizeof(zclApp_AttrsFirstEP) / sizeof(zclApp_AttrsFirstEP[0]));
 
-const cId_t zclApp_InClusterList[] = {ZCL_CLUSTER_ID_GEN_BASIC};
+const cId_t zclApp_InClusterList[] = {ZCL_CLUSTER_ID_GEN_BASIC, DIAGNOSTICS, POLL_CONTROL, FLOWER_CTRL};
 
 #define APP_MAX_INCLUSTERS (sizeof(zclApp_InClusterList) / sizeof(zclApp_InClusterList[0]))
 
-const cId_t zclApp_OutClusterListFirstEP[] = {POWER_CFG, ILLUMINANCE, TEMP, PRESSURE, HUMIDITY, SOIL_HUMIDITY};
-const cId_t zclApp_OutClusterListSecondEP[] = {TEMP};
+const cId_t zclApp_OutClusterListFirstEP[] = {POWER_CFG, APP_SENSORS_CLUSTERS_FIRST_EP(APP_CLUSTER_ID) FLOWER_CTRL};
 
 #define APP_MAX_OUTCLUSTERS_FIRST_EP (sizeof(zclApp_OutClusterListFirstEP) / sizeof(zclApp_OutClusterListFirstEP[0]))
-#define APP_MAX_OUTCLUSTERS_SECOND_EP (sizeof(zclApp_OutClusterListSecondEP) / sizeof(zclApp_OutClusterListSecondEP[0]))
 
 
 
@@ -149,6 +236,11 @@ SimpleDescriptionFormat_t zclApp_FirstEP = {
 };
 
 
+#if APP_SENSOR_DS18B20
+const cId_t zclApp_OutClusterListSecondEP[] = {APP_SENSORS_CLUSTERS_SECOND_EP(APP_CLUSTER_ID)};
+
+#define APP_MAX_OUTCLUSTERS_SECOND_EP (sizeof(zclApp_OutClusterListSecondEP) / sizeof(zclApp_OutClusterListSecondEP[0]))
+
 SimpleDescriptionFormat_t zclApp_SecondEP = {
     2,                                                  //  int Endpoint;
     ZCL_HA_PROFILE_ID,                                  //  uint16 AppProfId[2];
@@ -160,3 +252,27 @@ SimpleDescriptionFormat_t zclApp_SecondEP = {
     APP_MAX_OUTCLUSTERS_SECOND_EP,               //  byte  AppNumInClusters;
     (cId_t *)zclApp_OutClusterListSecondEP        //  byte *pAppInClusterList;
 };
+#endif
+
+#if APP_SOIL_EXTRA_CHANNELS > 0
+// extra soil channel, index is counted from channel 1
+#define APP_SOIL_EP_ATTRS(index, pin) {APP_SOIL_CHANNEL_ATTRS(APP_ATTR_RECORD, (index) + 1)},
+#define APP_SOIL_EP(index, pin)                                                                                                            \
+    {APP_SOIL_FIRST_EXTRA_EP + (index),                                                                                                    \
+     ZCL_HA_PROFILE_ID,                                                                                                                    \
+     ZCL_HA_DEVICEID_SIMPLE_SENSOR,                                                                                                        \
+     APP_DEVICE_VERSION,                                                                                                                   \
+     APP_FLAGS,                                                                                                                            \
+     0,                                                                                                                                    \
+     (cId_t *)NULL,                                                                                                                        \
+     APP_MAX_OUTCLUSTERS_SOIL_EP,                                                                                                          \
+     (cId_t *)zclApp_OutClusterListSoilEP},
+
+CONST zclAttrRec_t zclApp_AttrsSoilEPs[APP_SOIL_EXTRA_CHANNELS][APP_SOIL_EP_ATTRS_COUNT] = {SOIL_MOISTURE_EXTRA_CHANNELS(APP_SOIL_EP_ATTRS)};
+
+const cId_t zclApp_OutClusterListSoilEP[] = {SOIL_HUMIDITY};
+
+#define APP_MAX_OUTCLUSTERS_SOIL_EP (sizeof(zclApp_OutClusterListSoilEP) / sizeof(zclApp_OutClusterListSoilEP[0]))
+
+SimpleDescriptionFormat_t zclApp_SoilEPs[APP_SOIL_EXTRA_CHANNELS] = {SOIL_MOISTURE_EXTRA_CHANNELS(APP_SOIL_EP)};
+#endif
@@ -6,9 +6,39 @@ const {
 const ATTRID_MS_PRESSURE_MEASUREMENT_MEASURED_VALUE_HPA = 0x0200; // non standart attribute, max precision
 const ZCL_DATATYPE_UINT32 = 0x23;
 const ZCL_DATATYPE_UINT16 = 0x21;
+const ZCL_DATATYPE_UINT8 = 0x20;
+const ZCL_DATATYPE_BOOLEAN = 0x10;
+const ZCL_DATATYPE_ENUM8 = 0x30;
 const ATTRID_POWER_CFG_BATTERY_VOLTAGE_RAW_ADC = 0x0200;
+const ATTRID_POWER_CFG_BATTERY_CHEMISTRY = 0x0211; // 0 - 2xAA alkaline, 1 - CR2032
 const ATTRID_MS_RELATIVE_HUMIDITY_MEASURED_VALUE_RAW_ADC = 0x0200;
 const ATTRID_MS_RELATIVE_HUMIDITY_MEASURED_VALUE_BATTERY_RAW_ADC = 0x0201;
+const ATTRID_MS_TEMPERATURE_DS18B20_RESOLUTION = 0x0200;
+const ATTRID_MS_TEMPERATURE_DS18B20_PROBE_VALUE = 0x0220;
+const DS18B20_PROBES_MAX = 4;
+const SOIL_FIRST_EXTRA_ENDPOINT = 3;
+const ATTRID_REPORT_THRESHOLD = 0x0210;
+const ATTRID_SOIL_EXCITATION_SETTLE = 0x0211;
+const ATTRID_SOIL_EXCITATION_PERIOD = 0x0212;
+const ATTRID_BASIC_REPORT_HEARTBEAT = 0x0210;
+const ATTRID_BASIC_REPORT_INTERVAL = 0x0211;
+const ATTRID_BASIC_ADAPTIVE_INTERVAL = 0x0212;
+const ATTRID_BASIC_REPORT_INTERVAL_MIN = 0x0213;
+const ATTRID_BASIC_REPORT_INTERVAL_MAX = 0x0214;
+const ATTRID_POLL_CONTROL_CHECK_IN_INTERVAL = 0x0000; // quarter seconds, 0 - no check-in
+const ATTRID_POLL_CONTROL_FAST_POLL_TIMEOUT = 0x0003;
+
+const FLOWER_CTRL_CLUSTER = 0xFC01;
+const COMMAND_FLOWER_CTRL_HISTORY = 0x00;
+const ZCL_HEADER_SIZE = 3;
+const HISTORY_FRAME_HEADER_SIZE = 5;
+const HISTORY_RECORD_SIZE = 20;
+
+// device decides itself when to report (thresholds + heartbeat), so no periodic reports from bdb
+const REPORT_MAX_INTERVAL = 0;
+
+// device reports 10000 * log10(lux) + 1, same as msIlluminanceMeasurement, 0 - too dark
+const illuminanceLux = (value) => (value === 0 ? 0 : Math.round(Math.pow(10, (value - 1) / 10000)));
 
 const bind = async (endpoint, target, clusters) => {
     for (const cluster of clusters) {
@@ -60,6 +90,131 @@ const fz = {
             }
         },
     },
+    ds18b20_probes: {
+        cluster: 'msTemperatureMeasurement',
+        type: ['attributeReport', 'readResponse'],
+        convert: (model, msg, publish, options, meta) => {
+            const result = {};
+            for (let i = 0; i < DS18B20_PROBES_MAX; i++) {
+                const strAttrID = (ATTRID_MS_TEMPERATURE_DS18B20_PROBE_VALUE + i).toString();
+                if (msg.data[strAttrID] !== undefined) {
+                    result[`probe_temperature_${i + 1}`] = msg.data[strAttrID] / 100;
+                }
+            }
+            return result;
+        },
+    },
+    soil_extra_channels: {
+        // soil channels beyond the first one have own endpoints, channel = endpoint - 2
+        cluster: 'msSoilMoisture',
+        type: ['attributeReport', 'readResponse'],
+        convert: (model, msg, publish, options, meta) => {
+            if (msg.endpoint.ID < SOIL_FIRST_EXTRA_ENDPOINT || msg.data.measuredValue === undefined) {
+                return;
+            }
+            return {
+                [`soil_moisture_${msg.endpoint.ID - 1}`]: msg.data.measuredValue / 100,
+            };
+        },
+    },
+    history: {
+        // frames of private cluster aren't parsed by herdsman, so they come as raw
+        cluster: FLOWER_CTRL_CLUSTER,
+        type: ['raw'],
+        convert: (model, msg, publish, options, meta) => {
+            const data = Buffer.from(msg.data);
+            if (data.length < ZCL_HEADER_SIZE + HISTORY_FRAME_HEADER_SIZE || data[2] !== COMMAND_FLOWER_CTRL_HISTORY) {
+                return;
+            }
+            const payload = data.slice(ZCL_HEADER_SIZE);
+            const deviceClock = payload.readUInt32LE(0);
+            const count = payload.readUInt8(4);
+            const received = Date.now();
+            const history = [];
+            for (let i = 0; i < count; i++) {
+                const offset = HISTORY_FRAME_HEADER_SIZE + i * HISTORY_RECORD_SIZE;
+                const timestamp = payload.readUInt32LE(offset);
+                history.push({
+                    time: new Date(received - (deviceClock - timestamp) * 1000).toISOString(),
+                    sequence: payload.readUInt16LE(offset + 18),
+                    temperature_1: payload.readInt16LE(offset + 4) / 100,
+                    humidity_1: payload.readUInt16LE(offset + 6) / 100,
+                    pressure_1: payload.readInt16LE(offset + 8),
+                    illuminance_1: payload.readUInt16LE(offset + 10),
+                    illuminance_lux_1: illuminanceLux(payload.readUInt16LE(offset + 10)),
+                    soil_moisture: payload.readUInt16LE(offset + 12) / 100,
+                    temperature_2: payload.readInt16LE(offset + 14) / 100,
+                    voltage: payload.readUInt8(offset + 16) * 100,
+                });
+            }
+            return {
+                history,
+            };
+        },
+    },
+};
+
+const parseBoolean = (rawValue) => (rawValue === true || rawValue === 'true' || rawValue === 'ON' || rawValue === 1 || rawValue === '1' ? 1 : 0);
+
+const configAttribute = (key, endpointID, cluster, attrID, type, parse = (rawValue) => parseInt(rawValue, 10)) => ({
+    key: [key],
+    convertSet: async (entity, key, rawValue, meta) => {
+        const value = parse(rawValue);
+        const payload = {
+            [attrID]: {
+                value,
+                type,
+            },
+        };
+        await meta.device.getEndpoint(endpointID).write(cluster, payload);
+        return {
+            state: {
+                [key]: value,
+            },
+        };
+    },
+    convertGet: async (entity, key, meta) => {
+        await meta.device.getEndpoint(endpointID).read(cluster, [attrID]);
+    },
+});
+
+const tz = {
+    ds18b20_resolution: configAttribute('ds18b20_resolution', 2, 'msTemperatureMeasurement',
+        ATTRID_MS_TEMPERATURE_DS18B20_RESOLUTION, ZCL_DATATYPE_UINT8),
+    report_heartbeat: configAttribute('report_heartbeat', 1, 'genBasic',
+        ATTRID_BASIC_REPORT_HEARTBEAT, ZCL_DATATYPE_UINT16),
+    report_interval: configAttribute('report_interval', 1, 'genBasic',
+        ATTRID_BASIC_REPORT_INTERVAL, ZCL_DATATYPE_UINT16),
+    adaptive_interval: configAttribute('adaptive_interval', 1, 'genBasic',
+        ATTRID_BASIC_ADAPTIVE_INTERVAL, ZCL_DATATYPE_BOOLEAN, parseBoolean),
+    report_interval_min: configAttribute('report_interval_min', 1, 'genBasic',
+        ATTRID_BASIC_REPORT_INTERVAL_MIN, ZCL_DATATYPE_UINT16),
+    report_interval_max: configAttribute('report_interval_max', 1, 'genBasic',
+        ATTRID_BASIC_REPORT_INTERVAL_MAX, ZCL_DATATYPE_UINT16),
+    temperature_threshold: configAttribute('temperature_threshold', 1, 'msTemperatureMeasurement',
+        ATTRID_REPORT_THRESHOLD, ZCL_DATATYPE_UINT16),
+    humidity_threshold: configAttribute('humidity_threshold', 1, 'msRelativeHumidity',
+        ATTRID_REPORT_THRESHOLD, ZCL_DATATYPE_UINT16),
+    pressure_threshold: configAttribute('pressure_threshold', 1, 'msPressureMeasurement',
+        ATTRID_REPORT_THRESHOLD, ZCL_DATATYPE_UINT16),
+    illuminance_threshold: configAttribute('illuminance_threshold', 1, 'msIlluminanceMeasurement',
+        ATTRID_REPORT_THRESHOLD, ZCL_DATATYPE_UINT16),
+    soil_moisture_threshold: configAttribute('soil_moisture_threshold', 1, 'msSoilMoisture',
+        ATTRID_REPORT_THRESHOLD, ZCL_DATATYPE_UINT16),
+    battery_voltage_threshold: configAttribute('battery_voltage_threshold', 1, 'genPowerCfg',
+        ATTRID_REPORT_THRESHOLD, ZCL_DATATYPE_UINT16),
+    check_in_interval: configAttribute('check_in_interval', 1, 'genPollCtrl',
+        ATTRID_POLL_CONTROL_CHECK_IN_INTERVAL, ZCL_DATATYPE_UINT32),
+    fast_poll_timeout: configAttribute('fast_poll_timeout', 1, 'genPollCtrl',
+        ATTRID_POLL_CONTROL_FAST_POLL_TIMEOUT, ZCL_DATATYPE_UINT16),
+    battery_chemistry: configAttribute('battery_chemistry', 1, 'genPowerCfg',
+        ATTRID_POWER_CFG_BATTERY_CHEMISTRY, ZCL_DATATYPE_ENUM8),
+    soil_excitation_settle: configAttribute('soil_excitation_settle', 1, 'msSoilMoisture',
+        ATTRID_SOIL_EXCITATION_SETTLE, ZCL_DATATYPE_UINT16),
+    soil_excitation_period: configAttribute('soil_excitation_period', 1, 'msSoilMoisture',
+        ATTRID_SOIL_EXCITATION_PERIOD, ZCL_DATATYPE_UINT8),
+    ds18b20_threshold: configAttribute('ds18b20_threshold', 2, 'msTemperatureMeasurement',
+        ATTRID_REPORT_THRESHOLD, ZCL_DATATYPE_UINT16),
 };
 
 const device = {
@@ -74,13 +229,34 @@ const device = {
         withEpPreffix(fromZigbeeConverters.illuminance),
         withEpPreffix(fz.extended_pressure),
         fromZigbeeConverters.battery,
-        withEpPreffix(fz.extended_humidity)
+        withEpPreffix(fz.extended_humidity),
+        fz.ds18b20_probes,
+        fz.soil_extra_channels,
+        fz.history,
     ],
     toZigbee: [
         toZigbeeConverters.factory_reset,
+        tz.ds18b20_resolution,
+        tz.report_heartbeat,
+        tz.report_interval,
+        tz.adaptive_interval,
+        tz.report_interval_min,
+        tz.report_interval_max,
+        tz.temperature_threshold,
+        tz.humidity_threshold,
+        tz.pressure_threshold,
+        tz.illuminance_threshold,
+        tz.soil_moisture_threshold,
+        tz.battery_voltage_threshold,
+        tz.battery_chemistry,
+        tz.check_in_interval,
+        tz.fast_poll_timeout,
+        tz.soil_excitation_settle,
+        tz.soil_excitation_period,
+        tz.ds18b20_threshold,
     ],
     meta: {
-        configureKey: 1,
+        configureKey: 2,
         disableDefaultResponse: true,
     },
     configure: async (device, coordinatorEndpoint) => {
@@ -92,7 +268,8 @@ const device = {
             'msRelativeHumidity',
             'msPressureMeasurement',
             'msIlluminanceMeasurement',
-            'msSoilMoisture'
+            'msSoilMoisture',
+            'genPollCtrl'
         ]);
 
         await bind(secondEndpoint, coordinatorEndpoint, [
@@ -101,13 +278,13 @@ const device = {
         const genPowerCfgPayload = [{
                 attribute: 'batteryVoltage',
                 minimumReportInterval: 0,
-                maximumReportInterval: 3600,
+                maximumReportInterval: REPORT_MAX_INTERVAL,
                 reportableChange: 0,
             },
             {
                 attribute: 'batteryPercentageRemaining',
                 minimumReportInterval: 0,
-                maximumReportInterval: 3600,
+                maximumReportInterval: REPORT_MAX_INTERVAL,
                 reportableChange: 0,
             }
         ];
@@ -115,7 +292,7 @@ const device = {
         const msBindPayload = [{
             attribute: 'measuredValue',
             minimumReportInterval: 0,
-            maximumReportInterval: 3600,
+            maximumReportInterval: REPORT_MAX_INTERVAL,
             reportableChange: 0,
         }];
 
@@ -134,7 +311,7 @@ const device = {
                     type: ZCL_DATATYPE_UINT32,
                 },
                 minimumReportInterval: 0,
-                maximumReportInterval: 3600,
+                maximumReportInterval: REPORT_MAX_INTERVAL,
                 reportableChange: 0,
             },
         ];
@@ -148,7 +325,7 @@ const device = {
                     type: ZCL_DATATYPE_UINT16,
                 },
                 minimumReportInterval: 0,
-                maximumReportInterval: 3600,
+                maximumReportInterval: REPORT_MAX_INTERVAL,
                 reportableChange: 0,
             },
             {
@@ -157,11 +334,16 @@ const device = {
                     type: ZCL_DATATYPE_UINT16,
                 },
                 minimumReportInterval: 0,
-                maximumReportInterval: 3600,
+                maximumReportInterval: REPORT_MAX_INTERVAL,
                 reportableChange: 0,
             },
         ];
         await secondEndpoint.configureReporting('msSoilMoisture', msSoilMoistureBindPayload);
+
+        for (const endpoint of device.endpoints.filter((e) => e.ID >= SOIL_FIRST_EXTRA_ENDPOINT)) {
+            await bind(endpoint, coordinatorEndpoint, ['msSoilMoisture']);
+            await endpoint.configureReporting('msSoilMoisture', msBindPayload);
+        }
     },
 };
 
@@ -0,0 +1,264 @@
+import struct
+import sys
+import zlib
+
+# usage:
+#   python ota_delta.py diff old.hex new.hex patch.bin    - delta of new image against the one running on device
+#   python ota_delta.py pack new.hex patch.bin            - compressed full image, applied over empty base
+#   python ota_delta.py apply old.hex patch.bin new.bin   - rebuilds new image, old is omitted for packed image
+#   python ota_delta.py check old.hex new.hex             - diff, pack and apply both back, compares with new
+# images are .hex from IAR/releases or raw .bin, both are flattened to bytes from the lowest address
+#
+# patch layout, little endian:
+#   header: magic 'FDLT', version u8, old size u32, old crc32 u32, new size u32, new crc32 u32
+#   ops till new size is written, op byte is type in upper 2 bits and lower 5 bits of length,
+#   bit 5 set means rest of length follows as varint (7 bit groups, bit 7 - more groups follow):
+#     0 LITERAL  length, bytes
+#     1 FILL     length, byte                   - e.g. erased 0xFF padding
+#     2 OLD      length, offset varint          - copy from old image
+#     3 NEW      length, distance varint        - copy from already written part of new image
+# ops only read old image or bytes already written, so device can stream patch into a free image area
+# page by page and check crc32 of both images before switching over
+#
+# target flash area: this firmware has no OTA client yet, the tool is verified by its own check command and
+# tools/sim/ota_delta_test.py round trips, it's untested against a real client. On CC2530F256 (128 pages of 2 KB) running image ends below
+# HAL_HISTORY_PAGE_BEG, pages 117..120 are sample history (HAL_HISTORY_PAGE_*, reserved by CC2530DB/flower.xcl),
+# 121..126 are OSAL NV and 127 holds IEEE address and lock bits. None of them can take the new image,
+# history pages are also too small and history.c disables itself when they hold anything else.
+# Client needs either a second image area below HAL_HISTORY_PAGE_BEG (boot loader with two image slots,
+# each image at most half of pages 0..116) or external flash, as TI OAD does
+
+MAGIC = b'FDLT'
+VERSION = 1
+HEADER = struct.Struct('<4sBIIII')
+
+OP_LITERAL = 0
+OP_FILL = 1
+OP_OLD = 2
+OP_NEW = 3
+
+KEY_SIZE = 8
+MIN_MATCH = 12
+MIN_FILL = 8
+CANDIDATES = 16
+
+
+def read_image(path):
+    with open(path, 'rb') as fp:
+        data = fp.read()
+    if not path.lower().endswith('.hex'):
+        return data
+    chunks = {}
+    base = 0
+    for line in data.decode('ascii').splitlines():
+        line = line.strip()
+        if not line.startswith(':'):
+            continue
+        record = bytes.fromhex(line[1:])
+        length, address, kind = record[0], record[1] << 8 | record[2], record[3]
+        payload = record[4:4 + length]
+        if kind == 0x00:
+            chunks[base + address] = payload
+        elif kind == 0x02:
+            base = (payload[0] << 8 | payload[1]) << 4
+        elif kind == 0x04:
+            base = (payload[0] << 8 | payload[1]) << 16
+        elif kind == 0x01:
+            break
+    if not chunks:
+        return b''
+    start = min(chunks)
+    end = max(address + len(payload) for address, payload in chunks.items())
+    image = bytearray(b'\xFF' * (end - start))
+    for address, payload in chunks.items():
+        image[address - start:address - start + len(payload)] = payload
+    return bytes(image)
+
+
+def write_varint(out, value):
+    while True:
+        group = value & 0x7F
+        value >>= 7
+        if value:
+            out.append(group | 0x80)
+        else:
+            out.append(group)
+            return
+
+
+def read_varint(data, pos):
+    value = 0
+    shift = 0
+    while True:
+        group = data[pos]
+        pos += 1
+        value |= (group & 0x7F) << shift
+        shift += 7
+        if not group & 0x80:
+            return value, pos
+
+
+def write_op(out, kind, length):
+    # 5 bits of length fit op byte, bit 5 tells more groups follow
+    first = kind << 6 | (length & 0x1F)
+    length >>= 5
+    if length:
+        out.append(first | 0x20)
+        write_varint(out, length)
+    else:
+        out.append(first)
+
+
+def read_op(data, pos):
+    first = data[pos]
+    length = first & 0x1F
+    pos += 1
+    if first & 0x20:
+        more, pos = read_varint(data, pos)
+        length |= more << 5
+    return first >> 6, length, pos
+
+
+def index(data, limit=None):
+    positions = {}
+    for i in range(0, (limit if limit is not None else len(data)) - KEY_SIZE + 1):
+        positions.setdefault(data[i:i + KEY_SIZE], []).append(i)
+    return positions
+
+
+def match_length(a, a_pos, b, b_pos, limit):
+    length = 0
+    while length < limit and a[a_pos + length] == b[b_pos + length]:
+        length += 1
+    return length
+
+
+def best_match(new, pos, source, candidates, limit):
+    best = (0, 0)
+    for start in candidates[-CANDIDATES:]:
+        length = match_length(source, start, new, pos, min(limit, len(source) - start))
+        if length > best[0]:
+            best = (length, start)
+    return best
+
+
+def fill_length(new, pos):
+    length = 1
+    while pos + length < len(new) and new[pos + length] == new[pos]:
+        length += 1
+    return length
+
+
+def make_patch(old, new):
+    out = bytearray(HEADER.pack(MAGIC, VERSION, len(old), zlib.crc32(old), len(new), zlib.crc32(new)))
+    old_index = index(old)
+    new_index = {}
+    literal = bytearray()
+    indexed = 0
+    pos = 0
+
+    def flush_literal():
+        if literal:
+            write_op(out, OP_LITERAL, len(literal))
+            out.extend(literal)
+            literal.clear()
+
+    while pos < len(new):
+        # back references may only point to bytes already written
+        while indexed + KEY_SIZE <= pos:
+            new_index.setdefault(new[indexed:indexed + KEY_SIZE], []).append(indexed)
+            indexed += 1
+        left = len(new) - pos
+        fill = fill_length(new, pos)
+        key = new[pos:pos + KEY_SIZE]
+        old_match = best_match(new, pos, old, old_index.get(key, []), left)
+        new_match = best_match(new, pos, new, new_index.get(key, []), left)
+
+        if fill >= MIN_FILL and fill >= old_match[0] and fill >= new_match[0]:
+            flush_literal()
+            write_op(out, OP_FILL, fill)
+            out.append(new[pos])
+            pos += fill
+        elif old_match[0] >= MIN_MATCH and old_match[0] >= new_match[0]:
+            flush_literal()
+            write_op(out, OP_OLD, old_match[0])
+            write_varint(out, old_match[1])
+            pos += old_match[0]
+        elif new_match[0] >= MIN_MATCH:
+            flush_literal()
+            write_op(out, OP_NEW, new_match[0])
+            write_varint(out, pos - new_match[1])
+            pos += new_match[0]
+        else:
+            literal.append(new[pos])
+            pos += 1
+    flush_literal()
+    return bytes(out)
+
+
+def apply_patch(old, patch):
+    magic, version, old_size, old_crc, new_size, new_crc = HEADER.unpack_from(patch)
+    if magic != MAGIC or version != VERSION:
+        raise ValueError('not a patch')
+    if old_size != len(old) or zlib.crc32(old) != old_crc:
+        raise ValueError('patch was made for another image, size %d crc %08X' % (old_size, old_crc))
+    new = bytearray()
+    pos = HEADER.size
+    while len(new) < new_size:
+        kind, length, pos = read_op(patch, pos)
+        if kind == OP_LITERAL:
+            new.extend(patch[pos:pos + length])
+            pos += length
+        elif kind == OP_FILL:
+            new.extend(patch[pos:pos + 1] * length)
+            pos += 1
+        elif kind == OP_OLD:
+            offset, pos = read_varint(patch, pos)
+            new.extend(old[offset:offset + length])
+        else:
+            distance, pos = read_varint(patch, pos)
+            # may overlap with bytes it writes, like LZ77
+            for _ in range(length):
+                new.append(new[-distance])
+    if len(new) != new_size or zlib.crc32(new) != new_crc:
+        raise ValueError('rebuilt image crc mismatch')
+    return bytes(new)
+
+
+def check(old, new):
+    for name, base in (('diff', old), ('pack', b'')):
+        patch = make_patch(base, new)
+        ok = apply_patch(base, patch) == new
+        print('%s: %d -> %d bytes, %.1f%%, round trip %s' % (name, len(new), len(patch), 100.0 * len(patch) / max(len(new), 1),
+                                                             'ok' if ok else 'FAILED'))
+        if not ok:
+            return False
+    return True
+
+
+def main():
+    command, args = sys.argv[1], sys.argv[2:]
+    if command == 'diff':
+        patch = make_patch(read_image(args[0]), read_image(args[1]))
+        with open(args[2], 'wb') as fp:
+            fp.write(patch)
+    elif command == 'pack':
+        patch = make_patch(b'', read_image(args[0]))
+        with open(args[1], 'wb') as fp:
+            fp.write(patch)
+    elif command == 'apply':
+        old = read_image(args[0]) if len(args) == 3 else b''
+        with open(args[-2], 'rb') as fp:
+            new = apply_patch(old, fp.read())
+        with open(args[-1], 'wb') as fp:
+            fp.write(new)
+    elif command == 'check':
+        if not check(read_image(args[0]), read_image(args[1])):
+            sys.exit(1)
+    else:
+        print('unknown command %s' % command)
+        sys.exit(2)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,113 @@
+#include "bme280.h"
+#include "sim.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+#define BME280_CHIP_ID_ADDR 0xD0
+#define BME280_RESET_ADDR 0xE0
+#define BME280_SOFT_RESET_COMMAND 0xB6
+#define BME280_TEMP_PRESS_CALIB_DATA_ADDR 0x88
+#define BME280_TEMP_PRESS_CALIB_DATA_LEN 26
+#define BME280_HUMIDITY_CALIB_DATA_ADDR 0xE1
+#define BME280_HUMIDITY_CALIB_DATA_LEN 7
+#define BME280_CTRL_HUM_ADDR 0xF2
+#define BME280_PWR_CTRL_ADDR 0xF4
+#define BME280_CONFIG_ADDR 0xF5
+#define BME280_DATA_ADDR 0xF7
+#define BME280_P_T_H_DATA_LEN 8
+
+/**
+ * FYI: register traffic of Bosch BME280_driver 3.x for the calls zcl_app.c makes,
+ * so bus time and delays are the real ones, compensation is replaced by identity encoding of sim_i2c.c
+ * */
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static int8_t bme280_set_reg(uint8_t reg_addr, uint8_t value, const struct bme280_dev *dev);
+static int8_t bme280_update_reg(uint8_t reg_addr, uint8_t mask, uint8_t value, const struct bme280_dev *dev);
+
+int8_t bme280_get_regs(uint8_t reg_addr, uint8_t *reg_data, uint16_t len, const struct bme280_dev *dev) {
+    return dev->read(dev->dev_id, reg_addr, reg_data, len) == 0 ? BME280_OK : BME280_E_COMM_FAIL;
+}
+
+static int8_t bme280_set_reg(uint8_t reg_addr, uint8_t value, const struct bme280_dev *dev) {
+    return dev->write(dev->dev_id, reg_addr, &value, 1) == 0 ? BME280_OK : BME280_E_COMM_FAIL;
+}
+
+static int8_t bme280_update_reg(uint8_t reg_addr, uint8_t mask, uint8_t value, const struct bme280_dev *dev) {
+    uint8_t reg = 0;
+    int8_t rslt = bme280_get_regs(reg_addr, &reg, 1, dev);
+    if (rslt == BME280_OK) {
+        rslt = bme280_set_reg(reg_addr, (uint8_t)((reg & ~mask) | (value & mask)), dev);
+    }
+    return rslt;
+}
+
+int8_t bme280_init(struct bme280_dev *dev) {
+    uint8_t tries = 5;
+    uint8_t calib[BME280_TEMP_PRESS_CALIB_DATA_LEN];
+    int8_t rslt = BME280_E_DEV_NOT_FOUND;
+    while (tries--) {
+        uint8_t chipId = 0;
+        if (bme280_get_regs(BME280_CHIP_ID_ADDR, &chipId, 1, dev) == BME280_OK && chipId == BME280_CHIP_ID) {
+            dev->chip_id = chipId;
+            rslt = bme280_set_reg(BME280_RESET_ADDR, BME280_SOFT_RESET_COMMAND, dev);
+            if (rslt == BME280_OK) {
+                // start-up time of soft reset
+                sim_I2cStats.delayMs += 2;
+                dev->delay_ms(2);
+                rslt = bme280_get_regs(BME280_TEMP_PRESS_CALIB_DATA_ADDR, calib, BME280_TEMP_PRESS_CALIB_DATA_LEN, dev);
+            }
+            if (rslt == BME280_OK) {
+                rslt = bme280_get_regs(BME280_HUMIDITY_CALIB_DATA_ADDR, calib, BME280_HUMIDITY_CALIB_DATA_LEN, dev);
+            }
+            return rslt;
+        }
+        sim_I2cStats.delayMs += 1;
+        dev->delay_ms(1);
+    }
+    return rslt;
+}
+
+int8_t bme280_set_sensor_settings(uint8_t desired_settings, const struct bme280_dev *dev) {
+    uint8_t mode = 0;
+    int8_t rslt = bme280_get_regs(BME280_PWR_CTRL_ADDR, &mode, 1, dev);
+    if (rslt == BME280_OK && (desired_settings & BME280_OSR_HUM_SEL)) {
+        rslt = bme280_set_reg(BME280_CTRL_HUM_ADDR, dev->settings.osr_h & 0x07, dev);
+        // humidity setting becomes effective after ctrl_meas write
+        if (rslt == BME280_OK) {
+            rslt = bme280_update_reg(BME280_PWR_CTRL_ADDR, 0x00, 0x00, dev);
+        }
+    }
+    if (rslt == BME280_OK && (desired_settings & (BME280_OSR_PRESS_SEL | BME280_OSR_TEMP_SEL))) {
+        rslt = bme280_update_reg(BME280_PWR_CTRL_ADDR, 0xFC, (uint8_t)((dev->settings.osr_t << 5) | (dev->settings.osr_p << 2)), dev);
+    }
+    if (rslt == BME280_OK && (desired_settings & (BME280_FILTER_SEL | BME280_STANDBY_SEL))) {
+        rslt = bme280_update_reg(BME280_CONFIG_ADDR, 0xFC, (uint8_t)((dev->settings.standby_time << 5) | (dev->settings.filter << 2)),
+                                 dev);
+    }
+    return rslt;
+}
+
+int8_t bme280_set_sensor_mode(uint8_t sensor_mode, const struct bme280_dev *dev) {
+    uint8_t mode = 0;
+    int8_t rslt = bme280_get_regs(BME280_PWR_CTRL_ADDR, &mode, 1, dev);
+    if (rslt == BME280_OK) {
+        rslt = bme280_update_reg(BME280_PWR_CTRL_ADDR, 0x03, sensor_mode, dev);
+    }
+    return rslt;
+}
+
+int8_t bme280_get_sensor_data(uint8_t sensor_comp, struct bme280_data *comp_data, struct bme280_dev *dev) {
+    uint8_t data[BME280_P_T_H_DATA_LEN];
+    int8_t rslt = bme280_get_regs(BME280_DATA_ADDR, data, BME280_P_T_H_DATA_LEN, dev);
+    (void)sensor_comp;
+    if (rslt == BME280_OK) {
+        comp_data->pressure = ((uint32_t)data[0] << 12) | ((uint32_t)data[1] << 4) | (data[2] >> 4);
+        comp_data->temperature = (int32_t)(((uint32_t)data[3] << 12) | ((uint32_t)data[4] << 4) | (data[5] >> 4)) - 0x80000;
+        comp_data->humidity = (uint32_t)BUILD_UINT16(data[7], data[6]) * 2;
+    }
+    return rslt;
+}
@@ -0,0 +1,195 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_CYCLES() __rdtsc()
+#else
+#define BENCH_CYCLES() 0ULL
+#endif
+
+#include "conversion.h"
+#include "sim.h"
+
+/**
+ * FYI: integer conversions of conversion.c against double expressions they replaced,
+ * "bench" argument times both on host instead. Host has FPU, 8051 runs float math in software library,
+ * so numbers are good for catching regressions of integer code only, not for comparing it with double
+ * */
+
+/*********************************************************************
+ * CONSTANTS
+ */
+#define TEST_LOG10_ERROR 5 // documented in conversion.h
+#define TEST_ILLUMINANCE_ERROR (TEST_LOG10_ERROR * 4 * 100 / LIGHT_GAMMA + 1)
+#define BENCH_CALLS 2000000UL
+
+typedef struct {
+    uint32 pressure;
+    int8 scale;
+} test_Pressure_t;
+
+typedef struct {
+    uint16 raw;
+    uint16 air;
+    uint16 water;
+} test_Soil_t;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+static const uint32 log10Values[] = {1,     2,      3,      7,       9,        10,        15,         16,         17,        99,
+                                     100,   1000,   1023,   1024,    8191,     12345,     65535,      65536,      100000,    999999,
+                                     1000000, 7654321, 16777215, 16777216, 123456789, 1000000000, 2147483647, 2147483648U, 4294967295U};
+
+static const test_Pressure_t pressures[] = {{101325, 0}, {101325, -1}, {101325, -2}, {101325, -3}, {30000, -1}, {110000, -1},
+                                            {1013, 1},   {3276, 1},    {3277, 1},    {327, 2},     {101325, -9}, {101325, -10},
+                                            {5, 9},      {0, 5},       {32767, 0},   {32768, 0},   {1, 4},       {7, 3}};
+
+static const uint32 humidities[] = {0, 1, 10, 11, 1023, 1024, 10240, 51200, 51201, 99999, 102400, 102399};
+
+static const test_Soil_t soils[] = {{1000, 1000, 3000}, {3000, 1000, 3000}, {2000, 1000, 3000}, {999, 1000, 3000}, {3001, 1000, 3000},
+                                    {1500, 3000, 1000}, {3500, 3000, 1000}, {500, 3000, 1000},  {1234, 1234, 1234}, {0, 0, 8191},
+                                    {8191, 0, 8191},    {4095, 0, 8191},    {1001, 1000, 1003}, {7000, 2500, 7500}, {2501, 2500, 7500}};
+
+static const uint16 batteries[] = {0, 1, 4748, 5937, 7122, 7800, 8191};
+
+static volatile uint32 benchSink;
+
+/*********************************************************************
+ * REFERENCES, expressions conversion.c replaced
+ */
+static double test_Log10(uint32 value) { return CONVERSION_LOG_SCALE * log10((double)value); }
+
+static int16 test_ScalePressure(uint32 pressure, int8 scale) {
+    double scaled = floor(pow(10.0, scale) * pressure + 1e-9);
+    return scaled > 0x7FFF ? 0x7FFF : (int16)scaled;
+}
+
+static uint16 test_Humidity(uint32 humidity) { return (uint16)((double)humidity * 100.0 / 1024.0); }
+
+static uint16 test_Soil(uint16 raw, uint16 air, uint16 water) {
+    double mapped;
+    if (air == water) {
+        return 0;
+    }
+    mapped = trunc(((double)raw - air) * CONVERSION_HUMIDITY_MAX / ((double)water - air));
+    return mapped < 0 ? 0 : (uint16)MIN(mapped, CONVERSION_HUMIDITY_MAX);
+}
+
+static double test_BatteryMv(uint16 raw) { return (double)raw * CONVERSION_VDD_DIVIDER * CONVERSION_VDD_REF_MV / CONVERSION_ADC_FULL_SCALE; }
+
+static uint16 test_SoilAir(uint16 battery) { return (uint16)(0.179 * battery + 3926.0); }
+
+static uint16 test_SoilWater(uint16 battery) { return (uint16)(0.146 * battery + 2020.0); }
+
+static double test_Illuminance(uint16 raw, uint16 referenceMv) {
+    double uv = (double)raw * referenceMv * 1000.0 / CONVERSION_ADC_FULL_SCALE;
+    double lux = pow(uv / LIGHT_UV_PER_LUX, 100.0 / LIGHT_GAMMA);
+    return CONVERSION_LOG_SCALE * log10(lux) + 1;
+}
+
+/*********************************************************************
+ * TESTS
+ */
+static uint32 failures = 0;
+
+static void test_Check(const char *name, uint32 input, double expected, double actual, double error) {
+    if (fabs(expected - actual) > error) {
+        printf("%s(%u): expected %.2f, got %.0f\n", name, input, expected, actual);
+        failures++;
+    }
+}
+
+static void test_All(void) {
+    for (uint8 i = 0; i < sizeof(log10Values) / sizeof(log10Values[0]); i++) {
+        test_Check("log10Scaled", log10Values[i], test_Log10(log10Values[i]), log10Scaled(log10Values[i]), TEST_LOG10_ERROR);
+    }
+    // every mantissa step and a few between them
+    for (uint32 value = 1; value < 0x100000; value = value * 17 / 16 + 1) {
+        test_Check("log10Scaled", value, test_Log10(value), log10Scaled(value), TEST_LOG10_ERROR);
+    }
+    for (uint8 i = 0; i < sizeof(pressures) / sizeof(pressures[0]); i++) {
+        test_Check("scalePressure", pressures[i].pressure, test_ScalePressure(pressures[i].pressure, pressures[i].scale),
+                   scalePressure(pressures[i].pressure, pressures[i].scale), 0);
+    }
+    for (uint32 pressure = 30000; pressure <= 110000; pressure += 7) {
+        for (int8 scale = -3; scale <= 0; scale++) {
+            test_Check("scalePressure", pressure, test_ScalePressure(pressure, scale), scalePressure(pressure, scale), 0);
+        }
+    }
+    for (uint8 i = 0; i < sizeof(humidities) / sizeof(humidities[0]); i++) {
+        test_Check("convertHumidity", humidities[i], test_Humidity(humidities[i]), convertHumidity(humidities[i]), 0);
+    }
+    for (uint32 humidity = 0; humidity <= 102400; humidity++) {
+        test_Check("convertHumidity", humidity, test_Humidity(humidity), convertHumidity(humidity), 0);
+    }
+    for (uint8 i = 0; i < sizeof(soils) / sizeof(soils[0]); i++) {
+        test_Check("mapSoilHumidity", soils[i].raw, test_Soil(soils[i].raw, soils[i].air, soils[i].water),
+                   mapSoilHumidity(soils[i].raw, soils[i].air, soils[i].water), 0);
+    }
+    for (uint16 raw = 0; raw <= CONVERSION_ADC_FULL_SCALE; raw += 3) {
+        test_Check("mapSoilHumidity", raw, test_Soil(raw, 2600, 5200), mapSoilHumidity(raw, 2600, 5200), 0);
+    }
+    for (uint8 i = 0; i < sizeof(batteries) / sizeof(batteries[0]); i++) {
+        test_Check("convertBatteryMv", batteries[i], test_BatteryMv(batteries[i]), convertBatteryMv(batteries[i]), 0.5);
+        test_Check("convertBatteryZCL", batteries[i], round(test_BatteryMv(batteries[i]) / 100), convertBatteryZCL(convertBatteryMv(batteries[i])),
+                   0.5);
+    }
+    for (uint16 battery = 0; battery <= CONVERSION_ADC_FULL_SCALE; battery++) {
+        test_Check("convertSoilAirAdc", battery, test_SoilAir(battery), convertSoilAirAdc(battery), 1);
+        test_Check("convertSoilWaterAdc", battery, test_SoilWater(battery), convertSoilWaterAdc(battery), 1);
+    }
+    for (uint16 raw = 1; raw <= CONVERSION_ADC_FULL_SCALE; raw += 5) {
+        double expected = test_Illuminance(raw, 3000);
+        if (expected >= 1 && expected <= CONVERSION_ILLUMINANCE_MAX) {
+            test_Check("convertIlluminance", raw, expected, convertIlluminance(raw, 3000), TEST_ILLUMINANCE_ERROR);
+        }
+    }
+}
+
+/*********************************************************************
+ * BENCHMARK
+ */
+static double bench_Ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+#define BENCH(name, expression)                                                                                                            \
+    do {                                                                                                                                   \
+        double start = bench_Ns();                                                                                                         \
+        unsigned long long cycles = BENCH_CYCLES();                                                                                        \
+        for (uint32 i = 0; i < BENCH_CALLS; i++) {                                                                                         \
+            benchSink += (uint32)(expression);                                                                                             \
+        }                                                                                                                                  \
+        cycles = BENCH_CYCLES() - cycles;                                                                                                  \
+        printf("%-28s %6.1f ns/call %6.1f cycles/call\n", name, (bench_Ns() - start) / BENCH_CALLS, (double)cycles / BENCH_CALLS);         \
+    } while (0)
+
+static void bench_All(void) {
+    printf("host, %lu calls each\n", BENCH_CALLS);
+    BENCH("log10Scaled", log10Scaled(i | 1));
+    BENCH("log10 double", test_Log10(i | 1));
+    BENCH("scalePressure", scalePressure(90000 + (i & 0x3FFF), -1));
+    BENCH("pow double", test_ScalePressure(90000 + (i & 0x3FFF), -1));
+    BENCH("convertHumidity", convertHumidity(i & 0x1FFFF));
+    BENCH("humidity double", test_Humidity(i & 0x1FFFF));
+    BENCH("mapSoilHumidity", mapSoilHumidity(i & 0x1FFF, 2600, 5200));
+    BENCH("soil double", test_Soil(i & 0x1FFF, 2600, 5200));
+    BENCH("convertIlluminance", convertIlluminance(i & 0x1FFF, 3000));
+    BENCH("illuminance double", test_Illuminance(i & 0x1FFF, 3000));
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1 && strcmp(argv[1], "bench") == 0) {
+        bench_All();
+        return EXIT_SUCCESS;
+    }
+    test_All();
+    printf("%u failures\n", failures);
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
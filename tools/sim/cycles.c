@@ -0,0 +1,87 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "sim.h"
+
+/**
+ * FYI: runs boot cycle, join and a few report intervals, prints energy of every acquisition cycle
+ * as estimated by energy.c next to the one measured by simulator and fails if they drift apart
+ * */
+
+/*********************************************************************
+ * CONSTANTS
+ */
+#define CYCLES_JOIN_DELAY_MS 1500
+#define CYCLES_STEPS 36
+#define CYCLES_STEP_MS (5UL * 60 * 1000)
+// energy.c reads sleep timer at slightly different moments than simulator dispatches events
+#define CYCLES_TOLERANCE_MS 1
+
+static uint32 cycles_Ms(sim_Time_t ns) { return (uint32)(ns / 1000000ULL); }
+
+static bool cycles_Near(const char *what, uint8 cycle, uint32 firmware, uint32 simulated) {
+    uint32 diff = firmware > simulated ? firmware - simulated : simulated - firmware;
+    if (diff <= CYCLES_TOLERANCE_MS) {
+        return TRUE;
+    }
+    printf("cycle %d: %s firmware=%u simulated=%u\n", cycle, what, firmware, simulated);
+    return FALSE;
+}
+
+// charge of whole report period, same currents as energy.c
+static uint32 cycles_PeriodUAs(const sim_Stats_t *from, const sim_Stats_t *to, const sim_Cycle_t *cycle) {
+    unsigned long long awakeMs = cycles_Ms(to->awakeNs - from->awakeNs);
+    unsigned long long sleepMs = cycles_Ms(to->sleepNs - from->sleepNs);
+    unsigned long long chargeUAms = awakeMs * ENERGY_ACTIVE_UA + sleepMs * ENERGY_SLEEP_UA;
+    chargeUAms += (unsigned long long)cycle->firmware.sensorsOnMs * ENERGY_SENSORS_UA + (unsigned long long)cycle->firmware.excitationMs * ENERGY_EXCITATION_UA;
+    return (uint32)(chargeUAms / 1000 + (unsigned long long)(to->reportFrames - from->reportFrames + to->commands - from->commands) * ENERGY_TX_UAS);
+}
+
+int main(void) {
+    bool ok = TRUE;
+
+    sim_BatteryMv = 3000;
+    sim_AdcMv[SOIL_MOISTURE_PIN] = 1400;
+    sim_AdcMv[LUMOISITY_PIN] = 700;
+    sim_AdcNoise[SOIL_MOISTURE_PIN] = 4;
+    sim_AdcNoise[LUMOISITY_PIN] = 40;
+
+    sim_Boot();
+    sim_Run(CYCLES_JOIN_DELAY_MS);
+    sim_StateChange(DEV_END_DEVICE);
+    // soil dries and warms up, so some cycles have something to report
+    for (uint8 step = 0; step < CYCLES_STEPS; step++) {
+        sim_Run(CYCLES_STEP_MS);
+        sim_AdcMv[SOIL_MOISTURE_PIN] += 15;
+        sim_Bme280.temperature += 30;
+    }
+
+    printf("cycle | duration ms fw/sim | awake ms fw/sim | hold ms fw/sim | frames fw/sim | uAs fw | period s | period awake ms | "
+           "events | frames | polls | period uAs\n");
+    for (uint8 i = 0; i < sim_CycleLogCount; i++) {
+        const sim_Cycle_t *cycle = &sim_CycleLog[i];
+        const sim_Stats_t *next = i + 1 < sim_CycleLogCount ? &sim_CycleLog[i + 1].atStart : &sim_Stats;
+        if (cycle->durationNs == 0) {
+            continue;
+        }
+        printf("%5d | %8u/%-8u | %6u/%-8u | %5u/%-8u | %5u/%-7u | %6u | %8u | %15u | %6u | %6u | %5u | %10u\n", i,
+               cycle->firmware.durationMs, cycles_Ms(cycle->durationNs), cycle->firmware.awakeMs, cycles_Ms(cycle->awakeNs),
+               cycle->firmware.holdMs, cycles_Ms(cycle->holdNs), cycle->firmware.reports, cycle->reportFrames, cycle->firmware.energyUAs,
+               (uint32)(((next == &sim_Stats ? sim_Now : sim_CycleLog[i + 1].startNs) - cycle->startNs) / 1000000000ULL),
+               cycles_Ms(next->awakeNs - cycle->atStart.awakeNs), next->events - cycle->atStart.events,
+               next->reportFrames - cycle->atStart.reportFrames, next->polls - cycle->atStart.polls,
+               cycles_PeriodUAs(&cycle->atStart, next, cycle));
+        ok &= cycles_Near("duration", i, cycle->firmware.durationMs, cycles_Ms(cycle->durationNs));
+        ok &= cycles_Near("awake", i, cycle->firmware.awakeMs, cycles_Ms(cycle->awakeNs));
+        ok &= cycles_Near("hold", i, cycle->firmware.holdMs, cycles_Ms(cycle->holdNs));
+        if (cycle->firmware.reports != cycle->reportFrames) {
+            printf("cycle %d: reports firmware=%u simulated=%u\n", i, cycle->firmware.reports, cycle->reportFrames);
+            ok = FALSE;
+        }
+    }
+    if (sim_CycleLogCount < 2) {
+        printf("too few cycles %d\n", sim_CycleLogCount);
+        ok = FALSE;
+    }
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
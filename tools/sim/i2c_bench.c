@@ -0,0 +1,66 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sim.h"
+
+/**
+ * FYI: bus timing of i2c_fast.c against BME280 model, boot cycle with chip id, reset and calibration reads
+ * and a regular report cycle. Simulator counts delay loops and pin reads only, so SCL frequency is an upper bound,
+ * real one is lower by instruction overhead. Fails if tLOW or tHIGH are below fast mode minimums or any byte is NACKed
+ * */
+
+/*********************************************************************
+ * CONSTANTS
+ */
+#define BENCH_JOIN_DELAY_MS 1500
+#define BENCH_REPORT_MS (31UL * 60 * 1000) // default report interval is 1800 s
+// UM10204 fast mode
+#define BENCH_T_LOW_MIN_NS 1300
+#define BENCH_T_HIGH_MIN_NS 600
+
+static bool bench_Print(const char *phase, const sim_I2cStats_t *from, const sim_I2cStats_t *to) {
+    uint32 transactions = to->transactions - from->transactions;
+    uint32 bytes = to->bytes - from->bytes;
+    uint32 clocks = to->clocks - from->clocks;
+    uint32 busUs = (uint32)((to->busNs - from->busNs) / 1000);
+    uint32 lowNs = clocks ? (uint32)((to->clockLowNs - from->clockLowNs) / clocks) : 0;
+    uint32 highNs = clocks ? (uint32)((to->clockHighNs - from->clockHighNs) / clocks) : 0;
+    uint32 sclKHz = lowNs + highNs ? 1000000 / (lowNs + highNs) : 0;
+    bool ok = TRUE;
+
+    printf("%-7s | %12u | %5u | %6u | %7u | %7u | %8u | %6u | %7u | %8u\n", phase, transactions, bytes, clocks, sclKHz, lowNs,
+           highNs, busUs, bytes ? busUs * 1000 / bytes : 0, to->delayMs - from->delayMs);
+    if (transactions == 0) {
+        printf("%s: no bus traffic\n", phase);
+        ok = FALSE;
+    }
+    if (to->nacks != from->nacks) {
+        printf("%s: %u NACKs\n", phase, to->nacks - from->nacks);
+        ok = FALSE;
+    }
+    // averages, every period has the same delay loops, so shortest one is not far below
+    if (clocks && (lowNs < BENCH_T_LOW_MIN_NS || highNs < BENCH_T_HIGH_MIN_NS)) {
+        printf("%s: SCL out of fast mode limits\n", phase);
+        ok = FALSE;
+    }
+    return ok;
+}
+
+int main(void) {
+    sim_I2cStats_t boot, report;
+    bool ok = TRUE;
+
+    sim_BatteryMv = 3000;
+    sim_Boot();
+    sim_Run(BENCH_JOIN_DELAY_MS);
+    memcpy(&boot, &sim_I2cStats, sizeof(boot));
+    sim_StateChange(DEV_END_DEVICE);
+    sim_Run(BENCH_REPORT_MS);
+    memcpy(&report, &sim_I2cStats, sizeof(report));
+
+    printf("phase   | transactions | bytes | clocks | SCL kHz | tLOW ns | tHIGH ns | bus us | ns/byte | delay ms\n");
+    ok &= bench_Print("boot", &(sim_I2cStats_t){0}, &boot);
+    ok &= bench_Print("report", &boot, &report);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,139 @@
+import os
+import random
+import subprocess
+import sys
+import tempfile
+
+# usage:
+#   python ota_delta_test.py [ota_delta.py]    - round trip of ota_delta.py command line on generated image pairs
+# images look like firmware: code at the start, erased 0xFF padding, a few constant tables, written as .bin and .hex,
+# new image is old one with patched, inserted and removed bytes and a moved block
+
+TOOL = sys.argv[1] if len(sys.argv) > 1 else os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', '..', 'ota_delta.py')
+IMAGE_SIZE = 0x30000
+HEX_BASE = 0x10000
+HEX_RECORD = 32
+
+failures = 0
+
+
+def make_image(rng):
+    image = bytearray(b'\xFF' * IMAGE_SIZE)
+    code = IMAGE_SIZE * 3 // 4
+    image[:code] = bytes(rng.getrandbits(8) for _ in range(code))
+    for _ in range(8):
+        pos = rng.randrange(code - 256)
+        image[pos:pos + 256] = bytes(range(256))
+    return bytes(image)
+
+
+def modify(rng, old):
+    new = bytearray(old)
+    for _ in range(40):
+        pos = rng.randrange(len(new))
+        new[pos] = rng.getrandbits(8)
+    for _ in range(5):
+        pos = rng.randrange(len(new))
+        new[pos:pos] = bytes(rng.getrandbits(8) for _ in range(rng.randrange(1, 300)))
+    for _ in range(5):
+        pos = rng.randrange(len(new) - 300)
+        del new[pos:pos + rng.randrange(1, 300)]
+    src, dst = rng.randrange(len(new) // 2), rng.randrange(len(new) // 2, len(new) - 4096)
+    new[dst:dst + 4096] = new[src:src + 4096]
+    return bytes(new)
+
+
+def write_hex(path, data):
+    # extended linear address records, trailing 0xFF isn't written, as IAR leaves erased flash out
+    end = len(data.rstrip(b'\xFF'))
+    with open(path, 'w') as fp:
+        segment = None
+        for pos in range(0, end, HEX_RECORD):
+            address = HEX_BASE + pos
+            if address >> 16 != segment:
+                segment = address >> 16
+                fp.write(hex_record(0x04, 0, bytes([segment >> 8, segment & 0xFF])))
+            fp.write(hex_record(0x00, address & 0xFFFF, data[pos:min(pos + HEX_RECORD, end)]))
+        fp.write(hex_record(0x01, 0, b''))
+
+
+def hex_record(kind, address, payload):
+    record = bytes([len(payload), address >> 8, address & 0xFF, kind]) + payload
+    return ':%s%02X\n' % (record.hex().upper(), -sum(record) & 0xFF)
+
+
+def run(*args):
+    return subprocess.run([sys.executable, TOOL] + list(args), capture_output=True, text=True)
+
+
+def expect(name, condition, result=None):
+    global failures
+    if not condition:
+        print('%s: FAILED' % name)
+        if result is not None:
+            print(result.stdout + result.stderr)
+        failures += 1
+
+
+def read(path):
+    with open(path, 'rb') as fp:
+        return fp.read()
+
+
+def test_pair(directory, name, old, new, suffix):
+    old_path, new_path = os.path.join(directory, name + '_old' + suffix), os.path.join(directory, name + '_new' + suffix)
+    if suffix == '.hex':
+        write_hex(old_path, old)
+        write_hex(new_path, new)
+        old, new = old.rstrip(b'\xFF'), new.rstrip(b'\xFF')
+    else:
+        with open(old_path, 'wb') as fp:
+            fp.write(old)
+        with open(new_path, 'wb') as fp:
+            fp.write(new)
+    patch_path, packed_path = os.path.join(directory, name + '.patch'), os.path.join(directory, name + '.packed')
+    out_path = os.path.join(directory, name + '.bin')
+
+    result = run('diff', old_path, new_path, patch_path)
+    expect(name + ' diff', result.returncode == 0, result)
+    result = run('apply', old_path, patch_path, out_path)
+    expect(name + ' apply diff', result.returncode == 0 and read(out_path) == new, result)
+    expect(name + ' diff size', os.path.getsize(patch_path) < len(new) // 4)
+
+    result = run('pack', new_path, packed_path)
+    expect(name + ' pack', result.returncode == 0, result)
+    result = run('apply', packed_path, out_path)
+    expect(name + ' apply packed', result.returncode == 0 and read(out_path) == new, result)
+
+    result = run('check', old_path, new_path)
+    expect(name + ' check', result.returncode == 0, result)
+
+    # base of same size with one byte changed, only crc32 of old image tells it apart
+    wrong = bytearray(old)
+    wrong[len(wrong) // 2] ^= 0x01
+    wrong_path = os.path.join(directory, name + '_wrong.bin')
+    with open(wrong_path, 'wb') as fp:
+        fp.write(wrong)
+    os.remove(out_path)
+    result = run('apply', wrong_path, patch_path, out_path)
+    expect(name + ' wrong base refused', result.returncode != 0 and 'another image' in result.stderr and not os.path.exists(out_path),
+           result)
+    # new image as base, e.g. patch applied twice
+    result = run('apply', new_path, patch_path, out_path)
+    expect(name + ' new base refused', result.returncode != 0 and 'another image' in result.stderr, result)
+
+
+def main():
+    rng = random.Random(2020)
+    with tempfile.TemporaryDirectory() as directory:
+        for index in range(3):
+            old = make_image(rng)
+            new = modify(rng, old)
+            for suffix in ('.bin', '.hex'):
+                test_pair(directory, 'pair%d%s' % (index, suffix.replace('.', '_')), old, new, suffix)
+    print('%d failures' % failures)
+    sys.exit(1 if failures else 0)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,692 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sim.h"
+#include "zstack_lib.h"
+
+#include "energy.h"
+#include "version.h"
+#include "zcl_app.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+#define SIM_TASK 0
+#define SIM_TIMERS 16
+#define SIM_QUEUE 16
+#define SIM_NV_ITEMS 16
+#define SIM_NV_ITEM_SIZE 256
+#define SIM_FLASH_PAGES 128
+#define SIM_ZCL_ENDPOINTS 8
+
+#define SIM_NS_PER_MS 1000000ULL
+// AF_DATA_CONFIRM_CMD follows frame after MAC ack
+#define SIM_CONFIRM_DELAY_MS 10
+// full speed ADC conversion, (decimation + 16) ADC clocks of 4 MHz
+#define SIM_ADC_CONVERSION_NS(sdiv) (((64UL << ((sdiv) >> 4)) + 16) * 250)
+#define SIM_ADC_INTERNAL_REF_MV 1150
+#define SIM_ADC_FULL_SCALE 8191
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+typedef struct {
+    bool active;
+    uint8 task;
+    uint16 event;
+    sim_Time_t due;
+    uint32 reloadMs;
+} sim_Timer_t;
+
+typedef struct {
+    sim_Time_t due; // 0 - delivered
+    uint8 *msg;
+} sim_Message_t;
+
+typedef struct {
+    uint16 id; // 0 - free
+    uint16 len;
+    uint8 data[SIM_NV_ITEM_SIZE];
+} sim_NvItem_t;
+
+typedef struct {
+    uint8 endpoint;
+    uint8 count;
+    const zclAttrRec_t *attrs;
+} sim_AttrList_t;
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+sim_Time_t sim_Now = 0;
+sim_Stats_t sim_Stats;
+sim_Cycle_t sim_CycleLog[SIM_CYCLES_MAX];
+uint8 sim_CycleLogCount = 0;
+
+uint16 sim_BatteryMv = 3000;
+uint16 sim_AdcMv[8];
+uint16 sim_AdcNoise[8];
+
+// hal_mcu.h
+uint8 P0DIR, P1DIR, P2DIR, P0SEL, P1SEL, P2SEL, P0INP, P1INP, P2INP, PERCFG;
+uint8 P0_1, P1_0, P1_1, P1_3, P1_4;
+uint8 T3CTL, T3CCTL1, T3CC0;
+uint8 APCFG, ADCCON1, ADCCON2, DMAARM, X_ADCL;
+uint8 SLEEPCMD, SLEEPSTA, CLKCONCMD, CLKCONSTA, FCTL;
+halDMADesc_t sim_DmaDesc[5];
+
+// Z-Stack
+devStates_t devState = DEV_INIT;
+uint32 zgDefaultChannelList = 0x07FFF800;
+uint32 zgPollRate = 300000;
+nwkIB_t _NIB = {11};
+bdbAttributes_t bdbAttributes;
+bool requestNewTrustCenterLinkKey = TRUE;
+
+// Source/version.c is generated by ver.py before firmware build, simulator runs are reproducible
+const uint8 zclApp_DateCode[] = {16, '0', '1', '/', '0', '1', '/', '2', '0', '2', '0', ' ', '0', '0', ':', '0', '0'};
+const char zclApp_DateCodeNT[] = "01/01/2020 00:00";
+
+// zstack-lib
+uint8 zclBattery_Voltage = 0xFF;
+uint8 zclBattery_PercentageRemainig = 0xFF;
+uint16 zclBattery_RawAdc = 0xFFFF;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+static uint16 tasksEvents;
+static uint8 holdMask;
+static sim_Time_t holdSince;
+static uint32 pollRate;
+static sim_Time_t pollAccumulated;
+static sim_Timer_t timers[SIM_TIMERS];
+static sim_Message_t queue[SIM_QUEUE];
+static sim_NvItem_t nvItems[SIM_NV_ITEMS];
+static uint8 flash[SIM_FLASH_PAGES][HAL_FLASH_PAGE_SIZE];
+static sim_AttrList_t attrLists[SIM_ZCL_ENDPOINTS];
+static uint8 attrListsCount;
+
+static uint32 sleepTimerLatch;
+static uint8 adcReference = HAL_ADC_REF_AVDD;
+static sim_Time_t dmaArmed;
+static uint32 noiseSeed = 1;
+
+static bool sensorsPowered;
+static sim_Cycle_t *cycle; // acquisition in progress
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static void sim_AdcUpdate(void);
+static uint16 sim_AdcConvert(uint8 channel, uint8 reference);
+static void sim_Idle(sim_Time_t until);
+static void sim_Dispatch(void);
+static void sim_Deliver(uint8 *msg, uint32 delayMs);
+static void sim_CycleUpdate(sim_Time_t dispatchStart);
+
+/*********************************************************************
+ * Time
+ */
+void sim_Busy(sim_Time_t ns) {
+    sim_Now += ns;
+    sim_AdcUpdate();
+}
+
+void sim_Cycles(uint32 cycles) { sim_Busy((sim_Time_t)cycles * 1000 / SIM_CPU_MHZ); }
+
+void MicroWait(uint16 us) { sim_Busy((sim_Time_t)us * 1000); }
+
+uint8 sim_SleepTimer(uint8 index) {
+    sim_Cycles(SIM_SFR_READ_CYCLES);
+    if (index == 0) {
+        sleepTimerLatch = (uint32)(sim_Now * SIM_SLEEP_TIMER_HZ / 1000000000ULL);
+    }
+    return (uint8)(sleepTimerLatch >> (8 * index));
+}
+
+void sim_Nop(void) {
+    // pins written since previous update changed right before this loop, stamp their edges first
+    sim_I2cUpdate();
+    sim_Cycles(SIM_NOP_LOOP_CYCLES);
+}
+
+void sim_Log(const char *format, ...) {
+    static int verbose = -1;
+    va_list args;
+    if (verbose < 0) {
+        verbose = getenv("SIM_VERBOSE") != NULL;
+    }
+    if (!verbose) {
+        return;
+    }
+    printf("%10.3f ", (double)sim_Now / SIM_NS_PER_MS);
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+}
+
+/*********************************************************************
+ * OSAL
+ */
+uint8 osal_set_event(uint8 task_id, uint16 event_flag) {
+    (void)task_id;
+    tasksEvents |= event_flag;
+    return SUCCESS;
+}
+
+static uint8 sim_StartTimer(uint8 task_id, uint16 event_id, uint32 timeout, uint32 reload) {
+    sim_Timer_t *free = NULL;
+    for (uint8 i = 0; i < SIM_TIMERS; i++) {
+        if (timers[i].active && timers[i].task == task_id && timers[i].event == event_id) {
+            free = &timers[i];
+            break;
+        }
+        if (!timers[i].active && free == NULL) {
+            free = &timers[i];
+        }
+    }
+    if (free == NULL) {
+        fprintf(stderr, "sim: out of timers\n");
+        exit(2);
+    }
+    free->active = TRUE;
+    free->task = task_id;
+    free->event = event_id;
+    free->due = sim_Now + (sim_Time_t)timeout * SIM_NS_PER_MS;
+    free->reloadMs = reload;
+    return SUCCESS;
+}
+
+uint8 osal_start_timerEx(uint8 task_id, uint16 event_id, uint32 timeout_value) {
+    return sim_StartTimer(task_id, event_id, timeout_value, 0);
+}
+
+uint8 osal_start_reload_timer(uint8 taskID, uint16 event_id, uint32 timeout_value) {
+    return sim_StartTimer(taskID, event_id, timeout_value, timeout_value);
+}
+
+uint8 osal_stop_timerEx(uint8 task_id, uint16 event_id) {
+    for (uint8 i = 0; i < SIM_TIMERS; i++) {
+        if (timers[i].active && timers[i].task == task_id && timers[i].event == event_id) {
+            timers[i].active = FALSE;
+            return SUCCESS;
+        }
+    }
+    return FAILURE;
+}
+
+uint32 osal_GetSystemClock(void) { return (uint32)(sim_Now / SIM_NS_PER_MS); }
+
+uint32 osal_getClock(void) { return (uint32)(sim_Now / (1000 * SIM_NS_PER_MS)); }
+
+// hold is ground truth of energy.c hold time, handlers running meanwhile are in it too
+uint8 osal_pwrmgr_task_state(uint8 task_id, uint8 state) {
+    uint8 mask = state == PWRMGR_HOLD ? (holdMask | BV(task_id)) : (holdMask & ~BV(task_id));
+    if (mask && !holdMask) {
+        holdSince = sim_Now;
+    } else if (!mask && holdMask) {
+        sim_Stats.holdNs += sim_Now - holdSince;
+        if (cycle) {
+            cycle->holdNs += sim_Now - holdSince;
+        }
+    }
+    holdMask = mask;
+    return SUCCESS;
+}
+
+uint8 *osal_msg_receive(uint8 task_id) {
+    (void)task_id;
+    for (uint8 i = 0; i < SIM_QUEUE; i++) {
+        if (queue[i].msg != NULL && queue[i].due <= sim_Now) {
+            uint8 *msg = queue[i].msg;
+            queue[i].msg = NULL;
+            return msg;
+        }
+    }
+    return NULL;
+}
+
+uint8 osal_msg_deallocate(uint8 *msg_ptr) {
+    free(msg_ptr);
+    return SUCCESS;
+}
+
+void *osal_mem_alloc(uint16 size) { return malloc(size); }
+void osal_mem_free(void *ptr) { free(ptr); }
+void *osal_memcpy(void *dst, const void *src, unsigned int len) { return (uint8 *)memcpy(dst, src, len) + len; }
+void *osal_memset(void *dest, uint8 value, int len) { return memset(dest, value, len); }
+uint8 osal_memcmp(const void *src1, const void *src2, unsigned int len) { return memcmp(src1, src2, len) == 0; }
+
+uint8 *osal_buffer_uint32(uint8 *buf, uint32 val) {
+    *buf++ = BREAK_UINT32(val, 0);
+    *buf++ = BREAK_UINT32(val, 1);
+    *buf++ = BREAK_UINT32(val, 2);
+    *buf++ = BREAK_UINT32(val, 3);
+    return buf;
+}
+
+static sim_NvItem_t *sim_NvFind(uint16 id) {
+    for (uint8 i = 0; i < SIM_NV_ITEMS; i++) {
+        if (nvItems[i].id == id) {
+            return &nvItems[i];
+        }
+    }
+    return NULL;
+}
+
+uint8 osal_nv_item_init(uint16 id, uint16 len, void *buf) {
+    sim_NvItem_t *item = sim_NvFind(id);
+    if (item != NULL) {
+        return SUCCESS;
+    }
+    item = sim_NvFind(0);
+    if (item == NULL || len > SIM_NV_ITEM_SIZE) {
+        return NV_OPER_FAILED;
+    }
+    item->id = id;
+    item->len = len;
+    if (buf != NULL) {
+        memcpy(item->data, buf, len);
+    }
+    return NV_ITEM_UNINIT;
+}
+
+uint16 osal_nv_item_len(uint16 id) {
+    sim_NvItem_t *item = sim_NvFind(id);
+    return item ? item->len : 0;
+}
+
+uint8 osal_nv_read(uint16 id, uint16 offset, uint16 len, void *buf) {
+    sim_NvItem_t *item = sim_NvFind(id);
+    if (item == NULL || offset + len > item->len) {
+        return NV_OPER_FAILED;
+    }
+    memcpy(buf, item->data + offset, len);
+    return SUCCESS;
+}
+
+uint8 osal_nv_write(uint16 id, uint16 offset, uint16 len, void *buf) {
+    sim_NvItem_t *item = sim_NvFind(id);
+    if (item == NULL || offset + len > item->len) {
+        return NV_OPER_FAILED;
+    }
+    memcpy(item->data + offset, buf, len);
+    return SUCCESS;
+}
+
+uint8 osal_nv_delete(uint16 id, uint16 len) {
+    sim_NvItem_t *item = sim_NvFind(id);
+    if (item == NULL || item->len != len) {
+        return NV_OPER_FAILED;
+    }
+    item->id = 0;
+    return SUCCESS;
+}
+
+/*********************************************************************
+ * HAL
+ */
+uint8 RegisterForKeys(uint8 task_id) { return task_id; }
+
+uint8 HalLedSet(uint8 led, uint8 mode) {
+    (void)led;
+    return mode;
+}
+
+void HalFlashRead(uint8 pg, uint16 offset, uint8 *buf, uint16 cnt) { memcpy(buf, &flash[pg][offset], cnt); }
+
+void HalFlashWrite(uint16 addr, uint8 *buf, uint16 cnt) {
+    // address and count are in flash words, written bits can only be cleared
+    uint8 *dst = &flash[0][0] + (uint32)addr * HAL_FLASH_WORD_SIZE;
+    for (uint32 i = 0; i < (uint32)cnt * HAL_FLASH_WORD_SIZE; i++) {
+        dst[i] &= buf[i];
+    }
+}
+
+void HalFlashErase(uint8 pg) {
+    memset(flash[pg], 0xFF, HAL_FLASH_PAGE_SIZE);
+    // page erase takes 20 ms, CPU is halted meanwhile
+    sim_Busy(20 * SIM_NS_PER_MS);
+}
+
+void HalAdcSetReference(uint8 reference) { adcReference = reference; }
+
+bool HalAdcCheckVdd(uint8 vdd) { return sim_BatteryMv >= vdd * 100; }
+
+uint16 HalAdcRead(uint8 channel, uint8 resolution) {
+    uint8 sdiv = (uint8)((resolution - HAL_ADC_RESOLUTION_8) << 4);
+    sim_Busy(SIM_ADC_CONVERSION_NS(sdiv));
+    // same right aligned positive range as Z-Stack, 14 bit gives 0..8191
+    return sim_AdcConvert(channel, adcReference) >> (2 * (HAL_ADC_RESOLUTION_14 - resolution));
+}
+
+void sim_DmaArm(uint8 ch) {
+    DMAARM |= BV(ch);
+    dmaArmed = sim_Now;
+}
+
+// 13 bit positive result of a single conversion
+static uint16 sim_AdcConvert(uint8 channel, uint8 reference) {
+    uint32 mv = channel == HAL_ADC_CHANNEL_VDD ? sim_BatteryMv / 3 : sim_AdcMv[channel & 0x07];
+    uint32 referenceMv = (reference & 0xC0) == HAL_ADC_REF_AVDD ? sim_BatteryMv : SIM_ADC_INTERNAL_REF_MV;
+    int32 counts = (int32)(mv * SIM_ADC_FULL_SCALE / referenceMv);
+    uint16 noise = channel == HAL_ADC_CHANNEL_VDD ? 0 : sim_AdcNoise[channel & 0x07];
+    if (noise > 0) {
+        noiseSeed = noiseSeed * 1103515245 + 12345;
+        counts += (int32)((noiseSeed >> 16) % (2 * noise + 1)) - noise;
+    }
+    return (uint16)MAX(0, MIN(counts, SIM_ADC_FULL_SCALE));
+}
+
+/**
+ * FYI: DMA takes every conversion of ADC sequence AIN0..ADCCON2.SCH enabled in APCFG,
+ * buffer is filled at once when all conversions would have been done
+ * */
+static void sim_AdcUpdate(void) {
+    halDMADesc_t *ch = &sim_DmaDesc[HAL_DMA_CH_ADC];
+    uint8 last = ADCCON2 & 0x0F;
+    uint8 position = 0;
+    if (!(DMAARM & BV(HAL_DMA_CH_ADC)) || (ADCCON1 & 0x30) != 0x10 || APCFG == 0) {
+        return;
+    }
+    if (sim_Now - dmaArmed < (sim_Time_t)ch->len * SIM_ADC_CONVERSION_NS(ADCCON2 & 0x30)) {
+        return;
+    }
+    for (uint16 i = 0; i < ch->len; i++) {
+        while (!(APCFG & BV(position)) || position > last) {
+            position = position >= last ? 0 : position + 1;
+        }
+        ((uint16 *)ch->dst)[i] = sim_AdcConvert(position, ADCCON2) << 2;
+        position = position >= last ? 0 : position + 1;
+    }
+    DMAARM &= ~BV(HAL_DMA_CH_ADC);
+}
+
+/*********************************************************************
+ * ZDO, NWK, BDB
+ */
+ZStatus_t ZDO_RegisterForZDOMsg(uint8 taskID, uint16 clusterID) {
+    (void)taskID;
+    (void)clusterID;
+    return ZSuccess;
+}
+
+// stack restarts poll timer with the new rate
+void NLME_SetPollRate(uint32 newRate) {
+    pollRate = newRate;
+    pollAccumulated = 0;
+}
+
+void bdb_RegisterSimpleDescriptor(SimpleDescriptionFormat_t *simpleDesc) { (void)simpleDesc; }
+
+ZStatus_t bdb_ZedAttemptRecoverNwk(void) { return ZSuccess; }
+
+uint8 bdb_getZCLFrameCounter(void) {
+    static uint8 counter = 0;
+    return counter++;
+}
+
+void zclCommissioning_Init(uint8 task_id) { (void)task_id; }
+uint16 zclCommissioning_event_loop(uint8 task_id, uint16 events) {
+    (void)task_id;
+    (void)events;
+    return 0;
+}
+void zclCommissioning_HandleKeys(uint8 portAndAction, uint8 keyCode) {
+    (void)portAndAction;
+    (void)keyCode;
+}
+void zclFactoryResetter_Init(uint8 task_id) { (void)task_id; }
+void zclFactoryResetter_HandleKeys(uint8 portAndAction, uint8 keyCode) {
+    (void)portAndAction;
+    (void)keyCode;
+}
+
+/*********************************************************************
+ * ZCL
+ */
+ZStatus_t zclGeneral_RegisterCmdCallbacks(uint8 endpoint, zclGeneral_AppCallbacks_t *callbacks) {
+    (void)endpoint;
+    (void)callbacks;
+    return ZSuccess;
+}
+
+ZStatus_t zcl_registerAttrList(uint8 endpoint, uint8 numAttr, CONST zclAttrRec_t attrList[]) {
+    if (attrListsCount >= SIM_ZCL_ENDPOINTS) {
+        return ZFailure;
+    }
+    attrLists[attrListsCount].endpoint = endpoint;
+    attrLists[attrListsCount].count = numAttr;
+    attrLists[attrListsCount].attrs = attrList;
+    attrListsCount++;
+    return ZSuccess;
+}
+
+ZStatus_t zcl_registerReadWriteCB(uint8 endpoint, zclReadWriteCB_t pfnReadWriteCB, zclAuthorizeCB_t pfnAuthorizeCB) {
+    (void)endpoint;
+    (void)pfnReadWriteCB;
+    (void)pfnAuthorizeCB;
+    return ZSuccess;
+}
+
+uint8 zcl_registerValidateAttrData(zclValidateAttrData_t pfnValidateAttrData) {
+    (void)pfnValidateAttrData;
+    return TRUE;
+}
+
+ZStatus_t zcl_registerPlugin(uint16 startClusterID, uint16 endClusterID, zclInHdlr_t pfnIncomingHdlr) {
+    (void)startClusterID;
+    (void)endClusterID;
+    (void)pfnIncomingHdlr;
+    return ZSuccess;
+}
+
+uint8 zcl_registerForMsg(uint8 taskId) { return taskId; }
+
+uint8 zclFindAttrRec(uint8 endpoint, uint16 clusterID, uint16 attrId, zclAttrRec_t *pAttr) {
+    for (uint8 l = 0; l < attrListsCount; l++) {
+        if (attrLists[l].endpoint != endpoint) {
+            continue;
+        }
+        for (uint8 i = 0; i < attrLists[l].count; i++) {
+            if (attrLists[l].attrs[i].clusterID == clusterID && attrLists[l].attrs[i].attr.attrId == attrId) {
+                *pAttr = attrLists[l].attrs[i];
+                return TRUE;
+            }
+        }
+    }
+    return FALSE;
+}
+
+static void sim_Confirm(uint8 endpoint) {
+    afDataConfirm_t *confirm = malloc(sizeof(afDataConfirm_t));
+    confirm->hdr.event = AF_DATA_CONFIRM_CMD;
+    confirm->hdr.status = ZSuccess;
+    confirm->endpoint = endpoint;
+    confirm->transID = 0;
+    sim_Deliver((uint8 *)confirm, SIM_CONFIRM_DELAY_MS);
+}
+
+ZStatus_t zcl_SendReportCmd(uint8 srcEP, afAddrType_t *dstAddr, uint16 clusterID, zclReportCmd_t *reportCmd, uint8 direction,
+                            uint8 disableDefaultRsp, uint8 seqNum) {
+    (void)dstAddr;
+    (void)clusterID;
+    (void)direction;
+    (void)disableDefaultRsp;
+    (void)seqNum;
+    sim_Stats.reportFrames++;
+    sim_Stats.reportAttrs += reportCmd->numAttr;
+    sim_Confirm(srcEP);
+    return ZSuccess;
+}
+
+ZStatus_t zcl_SendCommand(uint8 srcEP, afAddrType_t *dstAddr, uint16 clusterID, uint8 cmd, uint8 specific, uint8 direction,
+                          uint8 disableDefaultRsp, uint16 manuCode, uint8 seqNum, uint16 cmdFormatLen, uint8 *cmdFormat) {
+    (void)dstAddr;
+    (void)clusterID;
+    (void)cmd;
+    (void)specific;
+    (void)direction;
+    (void)disableDefaultRsp;
+    (void)manuCode;
+    (void)seqNum;
+    (void)cmdFormatLen;
+    (void)cmdFormat;
+    sim_Stats.commands++;
+    sim_Confirm(srcEP);
+    return ZSuccess;
+}
+
+/*********************************************************************
+ * Scheduler
+ */
+static void sim_Deliver(uint8 *msg, uint32 delayMs) {
+    for (uint8 i = 0; i < SIM_QUEUE; i++) {
+        if (queue[i].msg == NULL) {
+            queue[i].msg = msg;
+            queue[i].due = sim_Now + (sim_Time_t)delayMs * SIM_NS_PER_MS;
+            if (delayMs == 0) {
+                osal_set_event(SIM_TASK, SYS_EVENT_MSG);
+            }
+            return;
+        }
+    }
+    fprintf(stderr, "sim: message queue full\n");
+    exit(2);
+}
+
+void sim_StateChange(devStates_t state) {
+    osal_event_hdr_t *msg = malloc(sizeof(osal_event_hdr_t));
+    msg->event = ZDO_STATE_CHANGE;
+    msg->status = (uint8)state;
+    devState = state;
+    sim_Deliver((uint8 *)msg, 0);
+}
+
+bool sim_SensorsPowered(void) { return P1_1 != 0; }
+
+void sim_Boot(void) {
+    memset(&sim_Stats, 0, sizeof(sim_Stats));
+    memset(sim_CycleLog, 0, sizeof(sim_CycleLog));
+    sim_CycleLogCount = 0;
+    cycle = NULL;
+    memset(flash, 0xFF, sizeof(flash));
+    // network is restored from NV, end device state comes with the first parent response
+    bdbAttributes.bdbNodeIsOnANetwork = TRUE;
+    devState = DEV_INIT;
+    sim_Busy(SIM_EVENT_CYCLES * 1000 / SIM_CPU_MHZ);
+    zclApp_Init(SIM_TASK);
+    sensorsPowered = sim_SensorsPowered();
+}
+
+static sim_Time_t sim_NextDue(void) {
+    sim_Time_t next = 0;
+    for (uint8 i = 0; i < SIM_TIMERS; i++) {
+        if (timers[i].active && (next == 0 || timers[i].due < next)) {
+            next = timers[i].due;
+        }
+    }
+    for (uint8 i = 0; i < SIM_QUEUE; i++) {
+        if (queue[i].msg != NULL && (next == 0 || queue[i].due < next)) {
+            next = queue[i].due;
+        }
+    }
+    return next;
+}
+
+// time between events, MCU sleeps in PM2 unless some task holds it, parent is polled meanwhile
+static void sim_Idle(sim_Time_t until) {
+    sim_Time_t ns = until > sim_Now ? until - sim_Now : 0;
+    if (holdMask) {
+        sim_Stats.awakeNs += ns;
+        if (cycle) {
+            cycle->awakeNs += ns;
+        }
+    } else {
+        sim_Stats.sleepNs += ns;
+    }
+    if (pollRate > 0) {
+        pollAccumulated += ns;
+        while (pollAccumulated >= (sim_Time_t)pollRate * SIM_NS_PER_MS) {
+            pollAccumulated -= (sim_Time_t)pollRate * SIM_NS_PER_MS;
+            sim_Stats.polls++;
+        }
+    }
+    sim_Now += ns;
+    sim_AdcUpdate();
+}
+
+static void sim_Dispatch(void) {
+    sim_Time_t start = sim_Now;
+    uint16 events = tasksEvents;
+    sim_Stats.events++;
+    tasksEvents = 0;
+    sim_Cycles(SIM_EVENT_CYCLES);
+    events = zclApp_event_loop(SIM_TASK, events);
+    tasksEvents |= events;
+    sim_Stats.awakeNs += sim_Now - start;
+    sim_CycleUpdate(start);
+}
+
+/**
+ * FYI: ground truth of acquisition cycle is taken from sensors power pin, it's checked after every dispatch,
+ * totals at cycle start give the whole report period together with the next cycle
+ * */
+static void sim_CycleUpdate(sim_Time_t dispatchStart) {
+    bool powered = sim_SensorsPowered();
+    if (powered && !sensorsPowered) {
+        cycle = sim_CycleLogCount < SIM_CYCLES_MAX ? &sim_CycleLog[sim_CycleLogCount++] : NULL;
+        if (cycle) {
+            cycle->startNs = dispatchStart;
+            cycle->atStart = sim_Stats;
+            // dispatch which started cycle is already counted in totals
+            cycle->atStart.awakeNs -= sim_Now - dispatchStart;
+            cycle->atStart.events--;
+        }
+    }
+    if (cycle && cycle->durationNs == 0) {
+        cycle->awakeNs += sim_Now - dispatchStart;
+        if (!powered) {
+            cycle->durationNs = sim_Now - cycle->startNs;
+            cycle->reportFrames = sim_Stats.reportFrames - cycle->atStart.reportFrames;
+            cycle->firmware = zclEnergy_LastCycle;
+            cycle = NULL;
+        }
+    }
+    sensorsPowered = powered;
+}
+
+void sim_Run(uint32 ms) {
+    sim_Time_t end = sim_Now + (sim_Time_t)ms * SIM_NS_PER_MS;
+    for (;;) {
+        sim_Time_t next;
+        if (tasksEvents) {
+            sim_Dispatch();
+            continue;
+        }
+        next = sim_NextDue();
+        if (next == 0 || next > end) {
+            sim_Idle(end);
+            break;
+        }
+        sim_Idle(next);
+        for (uint8 i = 0; i < SIM_TIMERS; i++) {
+            if (timers[i].active && timers[i].due <= sim_Now) {
+                osal_set_event(timers[i].task, timers[i].event);
+                if (timers[i].reloadMs) {
+                    timers[i].due += (sim_Time_t)timers[i].reloadMs * SIM_NS_PER_MS;
+                } else {
+                    timers[i].active = FALSE;
+                }
+            }
+        }
+        for (uint8 i = 0; i < SIM_QUEUE; i++) {
+            if (queue[i].msg != NULL && queue[i].due <= sim_Now) {
+                osal_set_event(SIM_TASK, SYS_EVENT_MSG);
+            }
+        }
+    }
+}
@@ -0,0 +1,125 @@
+#ifndef SIM_H
+#define SIM_H
+
+/**
+ * FYI: virtual time simulator of the application task. Source/ modules are built as is against stubs/,
+ * time advances only by event handlers (fixed cost), MicroWait, bit-banged bus delays, ADC conversions
+ * and sleep timer reads, so every run gives the same numbers
+ * */
+
+#include "zstack.h"
+
+#include "energy.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+#define SIM_CPU_MHZ 32
+#define SIM_SLEEP_TIMER_HZ 32768
+
+// cost of OSAL dispatching an event and handler code around modelled waits
+#ifndef SIM_EVENT_CYCLES
+#define SIM_EVENT_CYCLES 3200
+#endif
+// single iteration of delay loop with ASM_NOP, see I2C_FAST_LOW_LOOPS
+#define SIM_NOP_LOOP_CYCLES 6
+// SFR read of sleep timer or port pin
+#define SIM_SFR_READ_CYCLES 4
+
+#define SIM_CYCLES_MAX 32
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+typedef unsigned long long sim_Time_t; // ns
+
+typedef struct {
+    sim_Time_t awakeNs; // handlers and idling in PWRMGR_HOLD
+    sim_Time_t holdNs;  // PWRMGR_HOLD incl. handlers, counted when released
+    sim_Time_t sleepNs; // PM2
+    uint32 events;
+    uint32 reportFrames; // zcl_SendReportCmd
+    uint32 reportAttrs;
+    uint32 commands; // zcl_SendCommand, history and check-in
+    uint32 polls;    // parent polls at NLME_SetPollRate while idle
+} sim_Stats_t;
+
+// acquisition from sensors power on till off, measured by simulator
+typedef struct {
+    sim_Time_t startNs;
+    sim_Time_t durationNs;
+    sim_Time_t awakeNs;
+    sim_Time_t holdNs;
+    uint32 reportFrames;
+    sim_Stats_t atStart;          // totals when cycle started
+    zclEnergy_Cycle_t firmware; // zclEnergy_LastCycle right after cycle
+} sim_Cycle_t;
+
+typedef struct {
+    uint32 transactions; // START..STOP
+    uint32 bytes;        // incl. address bytes
+    uint32 clocks;       // SCL rising edges
+    uint32 nacks;        // address or written byte not acknowledged by slave
+    sim_Time_t busNs;      // START..STOP
+    sim_Time_t clockHighNs; // sum of SCL high times
+    sim_Time_t clockLowNs;  // sum of SCL low times inside transactions
+    uint32 delayMs;         // asked by driver through bme280_dev.delay_ms
+} sim_I2cStats_t;
+
+typedef struct {
+    int32 temperature; // 0.01 C
+    uint32 pressure;   // Pa
+    uint32 humidity;   // 1/1024 %RH
+    uint16 measurePercent; // measurement time, % of datasheet typical one
+} sim_Bme280_t;
+
+/*********************************************************************
+ * VARIABLES
+ */
+extern sim_Time_t sim_Now;
+extern sim_Stats_t sim_Stats;
+extern sim_I2cStats_t sim_I2cStats;
+extern sim_Bme280_t sim_Bme280;
+extern sim_Cycle_t sim_CycleLog[SIM_CYCLES_MAX];
+extern uint8 sim_CycleLogCount;
+
+extern uint16 sim_BatteryMv;
+extern uint16 sim_AdcMv[8];    // voltage on AIN pins
+extern uint16 sim_AdcNoise[8]; // peak noise, 14 bit counts
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+
+/*
+ * Advances virtual time by CPU busy time
+ */
+extern void sim_Cycles(uint32 cycles);
+extern void sim_Busy(sim_Time_t ns);
+
+/*
+ * Resets simulator and calls zclApp_Init, device is on network but not joined yet
+ */
+extern void sim_Boot(void);
+
+/*
+ * Runs events and timers for ms of virtual time
+ */
+extern void sim_Run(uint32 ms);
+
+/*
+ * Sends ZDO_STATE_CHANGE to application task
+ */
+extern void sim_StateChange(devStates_t state);
+
+/*
+ * TRUE while sensors power pin is on
+ */
+extern bool sim_SensorsPowered(void);
+
+/*
+ * I2C lines are sampled by BME280 model on every pin access and delay loop iteration
+ */
+extern void sim_I2cUpdate(void);
+
+#endif /* SIM_H */
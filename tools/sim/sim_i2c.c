@@ -0,0 +1,260 @@
+#include <string.h>
+
+#include "sim.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+#define SIM_I2C_SCL_BV BV(OCM_CLK_PIN)
+#define SIM_I2C_SDA_BV BV(OCM_DATA_PIN)
+
+#define SIM_BME280_ADDR 0x76
+#define SIM_BME280_REG_CALIB 0x88
+#define SIM_BME280_REG_ID 0xD0
+#define SIM_BME280_REG_RESET 0xE0
+#define SIM_BME280_REG_CTRL_HUM 0xF2
+#define SIM_BME280_REG_STATUS 0xF3
+#define SIM_BME280_REG_CTRL_MEAS 0xF4
+#define SIM_BME280_REG_DATA 0xF7
+#define SIM_BME280_RESET_VALUE 0xB6
+#define SIM_BME280_STATUS_MEASURING 0x08
+
+typedef enum { SIM_I2C_IDLE, SIM_I2C_ADDRESS, SIM_I2C_REGISTER, SIM_I2C_WRITE, SIM_I2C_READ } sim_I2cState_t;
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+sim_I2cStats_t sim_I2cStats;
+sim_Bme280_t sim_Bme280 = {2150, 101325, 50 * 1024, 100};
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+static uint8 pins[2];
+static bool scl = TRUE;
+static bool sda = TRUE;
+static bool sdaDriven = FALSE; // slave pulls SDA low
+static sim_Time_t sclEdge;
+static sim_Time_t transactionStart;
+static bool busy = FALSE; // between START and STOP
+
+static sim_I2cState_t state = SIM_I2C_IDLE;
+static uint8 bit;   // bits of current byte clocked in or out, 8 - acknowledge clock
+static uint8 shift; // byte being received or transmitted
+static bool acked;
+
+static bool powered = FALSE;
+static uint8 regs[256];
+static uint8 address;
+static sim_Time_t measuringUntil;
+static bool dataLatched = TRUE;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static void sim_Bme280Reset(void);
+static uint8 sim_Bme280Read(uint8 reg);
+static void sim_Bme280Write(uint8 reg, uint8 value);
+static void sim_I2cRise(void);
+static void sim_I2cFall(void);
+
+uint8 *sim_I2cPin(uint8 line) {
+    sim_I2cUpdate();
+    sim_Cycles(SIM_SFR_READ_CYCLES);
+    pins[line] = line == 0 ? scl : sda;
+    return &pins[line];
+}
+
+/**
+ * FYI: lines are pulled up unless master drives them through direction register or slave pulls SDA low,
+ * edges are seen only when CPU touches pins or spins delay loop, that's when they change anyway
+ * */
+void sim_I2cUpdate(void) {
+    bool nowPowered = sim_SensorsPowered();
+    bool newScl, newSda;
+    if (nowPowered != powered) {
+        powered = nowPowered;
+        sim_Bme280Reset();
+        state = SIM_I2C_IDLE;
+        sdaDriven = FALSE;
+    }
+    newScl = !(OCM_CLK_DIR & SIM_I2C_SCL_BV);
+    if (newScl != scl) {
+        if (busy) {
+            if (newScl) {
+                sim_I2cStats.clockLowNs += sim_Now - sclEdge;
+            } else {
+                sim_I2cStats.clockHighNs += sim_Now - sclEdge;
+            }
+        }
+        sclEdge = sim_Now;
+        scl = newScl;
+        if (scl) {
+            sim_I2cStats.clocks++;
+            sda = !(OCM_DATA_DIR & SIM_I2C_SDA_BV) && !sdaDriven;
+            sim_I2cRise();
+        } else {
+            sim_I2cFall();
+        }
+    }
+    newSda = !(OCM_DATA_DIR & SIM_I2C_SDA_BV) && !sdaDriven;
+    if (newSda != sda) {
+        sda = newSda;
+        if (scl && !sda) {
+            // START or repeated START
+            if (!busy) {
+                busy = TRUE;
+                transactionStart = sim_Now;
+                sclEdge = sim_Now; // idle bus isn't part of clock high time
+                sim_I2cStats.transactions++;
+            }
+            state = SIM_I2C_ADDRESS;
+            bit = 0;
+            shift = 0;
+            acked = TRUE;
+        } else if (scl && sda && busy) {
+            // STOP
+            sim_I2cStats.busNs += sim_Now - transactionStart;
+            busy = FALSE;
+            state = SIM_I2C_IDLE;
+        }
+    }
+}
+
+static void sim_I2cRise(void) {
+    if (state == SIM_I2C_IDLE || !powered) {
+        return;
+    }
+    if (bit < 8) {
+        if (state != SIM_I2C_READ) {
+            shift = (uint8)((shift << 1) | (sda ? 1 : 0));
+        }
+        bit++;
+        return;
+    }
+    // acknowledge clock, master NACKs last byte of read burst, that's not counted as an error
+    if (state == SIM_I2C_READ) {
+        acked = !sda;
+    }
+}
+
+static void sim_I2cFall(void) {
+    if (state == SIM_I2C_IDLE || !powered) {
+        return;
+    }
+    if (bit == 8 && state != SIM_I2C_READ) {
+        // last bit of received byte, acknowledge or ignore it
+        sim_I2cStats.bytes++;
+        switch (state) {
+        case SIM_I2C_ADDRESS:
+            if ((shift >> 1) != SIM_BME280_ADDR) {
+                sim_I2cStats.nacks++;
+                state = SIM_I2C_IDLE;
+                return;
+            }
+            state = (shift & 0x01) ? SIM_I2C_READ : SIM_I2C_REGISTER;
+            break;
+        case SIM_I2C_REGISTER:
+            address = shift;
+            state = SIM_I2C_WRITE;
+            break;
+        case SIM_I2C_WRITE:
+            // BME280 takes register address and data pairs, there is no auto-increment on write
+            sim_Bme280Write(address, shift);
+            state = SIM_I2C_REGISTER;
+            break;
+        default:
+            break;
+        }
+        sdaDriven = TRUE;
+        bit = 9;
+        return;
+    }
+    if (bit == 8 && state == SIM_I2C_READ) {
+        // master acknowledges
+        sdaDriven = FALSE;
+        bit = 9;
+        return;
+    }
+    if (bit == 9) {
+        // end of acknowledge clock
+        sdaDriven = FALSE;
+        bit = 0;
+        shift = 0;
+        if (state == SIM_I2C_READ && acked) {
+            sim_I2cStats.bytes++;
+            shift = sim_Bme280Read(address++);
+            sdaDriven = !(shift & 0x80);
+        }
+        return;
+    }
+    if (state == SIM_I2C_READ && bit < 8) {
+        sdaDriven = !(shift & (0x80 >> bit));
+    }
+}
+
+/*********************************************************************
+ * BME280
+ */
+static void sim_Bme280Reset(void) {
+    memset(regs, 0, sizeof(regs));
+    regs[SIM_BME280_REG_ID] = 0x60;
+    for (uint8 i = 0; i < 26; i++) {
+        regs[SIM_BME280_REG_CALIB + i] = (uint8)(0x40 + i);
+    }
+    for (uint8 i = 0; i < 7; i++) {
+        regs[0xE1 + i] = (uint8)(0x20 + i);
+    }
+    measuringUntil = 0;
+    dataLatched = TRUE;
+    acked = TRUE;
+}
+
+static uint32 sim_Bme280Osr(uint8 osr) { return osr ? (1UL << (osr - 1)) : 0; }
+
+static uint8 sim_Bme280Read(uint8 reg) {
+    if (!dataLatched && sim_Now >= measuringUntil) {
+        // identity encoding, compensation is left out by simulator's bme280.c
+        uint32 pressure = sim_Bme280.pressure;
+        uint32 temperature = (uint32)(sim_Bme280.temperature + 0x80000);
+        uint16 humidity = (uint16)(sim_Bme280.humidity / 2);
+        regs[0xF7] = (uint8)(pressure >> 12);
+        regs[0xF8] = (uint8)(pressure >> 4);
+        regs[0xF9] = (uint8)(pressure << 4);
+        regs[0xFA] = (uint8)(temperature >> 12);
+        regs[0xFB] = (uint8)(temperature >> 4);
+        regs[0xFC] = (uint8)(temperature << 4);
+        regs[0xFD] = HI_UINT16(humidity);
+        regs[0xFE] = LO_UINT16(humidity);
+        regs[SIM_BME280_REG_CTRL_MEAS] &= ~0x03; // back to sleep after forced measurement
+        dataLatched = TRUE;
+    }
+    if (reg == SIM_BME280_REG_STATUS) {
+        return sim_Now < measuringUntil ? SIM_BME280_STATUS_MEASURING : 0;
+    }
+    return regs[reg];
+}
+
+static void sim_Bme280Write(uint8 reg, uint8 value) {
+    if (reg == SIM_BME280_REG_RESET) {
+        if (value == SIM_BME280_RESET_VALUE) {
+            sim_Bme280Reset();
+        }
+        return;
+    }
+    regs[reg] = value;
+    if (reg == SIM_BME280_REG_CTRL_MEAS && (value & 0x03) != 0 && (value & 0x03) != 0x03) {
+        // datasheet 9.1 typical measurement time, humidity setting is applied by ctrl_meas write
+        uint32 us = 1000 + 2000 * sim_Bme280Osr(value >> 5);
+        uint8 osrP = (value >> 2) & 0x07;
+        uint8 osrH = regs[SIM_BME280_REG_CTRL_HUM] & 0x07;
+        if (osrP) {
+            us += 2000 * sim_Bme280Osr(osrP) + 500;
+        }
+        if (osrH) {
+            us += 2000 * sim_Bme280Osr(osrH) + 500;
+        }
+        measuringUntil = sim_Now + (sim_Time_t)us * 10 * sim_Bme280.measurePercent;
+        dataLatched = FALSE;
+    }
+}
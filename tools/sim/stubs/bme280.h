@@ -0,0 +1,77 @@
+#ifndef SIM_BME280_H
+#define SIM_BME280_H
+
+/**
+ * FYI: subset of Bosch BME280_driver API used by zcl_app.c, implemented by bme280.c of the simulator,
+ * register traffic follows the driver, compensation is left out
+ * */
+
+#include "hal.h"
+
+#define BME280_OK 0
+#define BME280_E_NULL_PTR -1
+#define BME280_E_DEV_NOT_FOUND -2
+#define BME280_E_COMM_FAIL -4
+
+#define BME280_I2C_ADDR_PRIM 0x76
+#define BME280_CHIP_ID 0x60
+
+#define BME280_NO_OVERSAMPLING 0x00
+#define BME280_OVERSAMPLING_1X 0x01
+#define BME280_OVERSAMPLING_2X 0x02
+#define BME280_OVERSAMPLING_4X 0x03
+#define BME280_OVERSAMPLING_8X 0x04
+#define BME280_OVERSAMPLING_16X 0x05
+#define BME280_FILTER_COEFF_OFF 0x00
+
+#define BME280_OSR_PRESS_SEL 1
+#define BME280_OSR_TEMP_SEL (1 << 1)
+#define BME280_OSR_HUM_SEL (1 << 2)
+#define BME280_FILTER_SEL (1 << 3)
+#define BME280_STANDBY_SEL (1 << 4)
+
+#define BME280_PRESS 1
+#define BME280_TEMP (1 << 1)
+#define BME280_HUM (1 << 2)
+#define BME280_ALL 0x07
+
+#define BME280_SLEEP_MODE 0x00
+#define BME280_FORCED_MODE 0x01
+#define BME280_NORMAL_MODE 0x03
+
+enum bme280_intf { BME280_SPI_INTF, BME280_I2C_INTF };
+
+typedef int8_t (*bme280_com_fptr_t)(uint8_t dev_id, uint8_t reg_addr, uint8_t *data, uint16_t len);
+typedef void (*bme280_delay_fptr_t)(uint32_t period);
+
+struct bme280_settings {
+    uint8_t osr_p;
+    uint8_t osr_t;
+    uint8_t osr_h;
+    uint8_t filter;
+    uint8_t standby_time;
+};
+
+struct bme280_data {
+    uint32_t pressure;   // Pa
+    int32_t temperature; // 0.01 C
+    uint32_t humidity;   // 1/1024 %RH
+};
+
+struct bme280_dev {
+    uint8_t chip_id;
+    uint8_t dev_id;
+    enum bme280_intf intf;
+    bme280_com_fptr_t read;
+    bme280_com_fptr_t write;
+    bme280_delay_fptr_t delay_ms;
+    struct bme280_settings settings;
+};
+
+extern int8_t bme280_init(struct bme280_dev *dev);
+extern int8_t bme280_get_regs(uint8_t reg_addr, uint8_t *reg_data, uint16_t len, const struct bme280_dev *dev);
+extern int8_t bme280_set_sensor_settings(uint8_t desired_settings, const struct bme280_dev *dev);
+extern int8_t bme280_set_sensor_mode(uint8_t sensor_mode, const struct bme280_dev *dev);
+extern int8_t bme280_get_sensor_data(uint8_t sensor_comp, struct bme280_data *comp_data, struct bme280_dev *dev);
+
+#endif /* SIM_BME280_H */
@@ -0,0 +1,193 @@
+#ifndef SIM_HAL_H
+#define SIM_HAL_H
+
+/**
+ * FYI: host stand-in for Z-Stack HAL headers (hal_types.h, hal_mcu.h, hal_adc.h, hal_dma.h, ...),
+ * only what Source/ uses. SFRs are plain variables, sleep timer, ADC/DMA and I2C pins are driven by sim.c
+ * */
+
+#include <stddef.h>
+
+/*********************************************************************
+ * TYPES
+ */
+typedef signed char int8;
+typedef unsigned char uint8;
+typedef signed short int16;
+typedef unsigned short uint16;
+typedef signed int int32;
+typedef unsigned int uint32;
+typedef signed long int64;
+typedef unsigned char bool;
+typedef uint8 byte;
+typedef uint16 UINT16;
+typedef uint8 halIntState_t;
+
+#ifndef TRUE
+#define TRUE 1
+#endif
+#ifndef FALSE
+#define FALSE 0
+#endif
+#ifndef NULL
+#define NULL ((void *)0)
+#endif
+
+#define CONST const
+#define __code
+#define __xdata
+
+/*********************************************************************
+ * hal_defs.h
+ */
+#define BV(n) (1 << (n))
+#define st(x)                                                                                                                              \
+    do {                                                                                                                                   \
+        x                                                                                                                                  \
+    } while (__LINE__ == -1)
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+#define MAX(a, b) (((a) > (b)) ? (a) : (b))
+#define BUILD_UINT16(loByte, hiByte) ((uint16)(((loByte)&0x00FF) + (((hiByte)&0x00FF) << 8)))
+#define BUILD_UINT32(Byte0, Byte1, Byte2, Byte3)                                                                                           \
+    ((uint32)((uint32)((Byte0)&0x00FF) + ((uint32)((Byte1)&0x00FF) << 8) + ((uint32)((Byte2)&0x00FF) << 16) +                              \
+              ((uint32)((Byte3)&0x00FF) << 24)))
+#define BREAK_UINT32(var, ByteNum) (uint8)((uint32)(((var) >> ((ByteNum)*8)) & 0x00FF))
+#define HI_UINT16(a) (((a) >> 8) & 0xFF)
+#define LO_UINT16(a) ((a)&0xFF)
+#define HI_UINT32(a) ((uint16)(((a) >> 16) & 0xFFFF))
+#define LO_UINT32(a) ((uint16)((a)&0xFFFF))
+
+/*********************************************************************
+ * hal_mcu.h
+ */
+extern uint8 P0DIR, P1DIR, P2DIR, P0SEL, P1SEL, P2SEL, P0INP, P1INP, P2INP, PERCFG;
+extern uint8 P0_1, P1_0, P1_1, P1_3, P1_4;
+extern uint8 T3CTL, T3CCTL1, T3CC0;
+extern uint8 APCFG, ADCCON1, ADCCON2, DMAARM, X_ADCL;
+extern uint8 SLEEPCMD, SLEEPSTA, CLKCONCMD, CLKCONSTA, FCTL;
+
+// I2C lines follow pin direction, pull-ups and BME280 model, see sim_I2cPin
+#define P0_5 (*sim_I2cPin(0))
+#define P0_6 (*sim_I2cPin(1))
+extern uint8 *sim_I2cPin(uint8 line);
+
+// sleep timer runs from virtual time, reading a byte costs a few CPU cycles
+#define ST0 sim_SleepTimer(0)
+#define ST1 sim_SleepTimer(1)
+#define ST2 sim_SleepTimer(2)
+extern uint8 sim_SleepTimer(uint8 index);
+
+#define ASM_NOP sim_Nop()
+extern void sim_Nop(void);
+#define asm(x) sim_Nop()
+
+#define HAL_ENTER_CRITICAL_SECTION(x) st(x = 0;)
+#define HAL_EXIT_CRITICAL_SECTION(x) st((void)(x);)
+
+#define CLKCONCMD_32MHZ 0
+#define OSC_PD 0x04
+#define XOSC_STB 0x40
+
+/*********************************************************************
+ * OnBoard.h
+ */
+extern void MicroWait(uint16 us);
+
+#define IO_PUP 0
+#define IO_PDN 1
+#define IO_TRI 1
+// blocks like in Z-Stack, some calls come without semicolon
+#define IO_PUD_PORT(port, dir) { (void)(port); (void)(dir); }
+#define IO_IMODE_PORT_PIN(port, pin, mode) { (void)(port); (void)(pin); (void)(mode); }
+
+#define KEY_CHANGE 0xC0
+typedef struct {
+    uint8 event;
+    uint8 status;
+} osal_event_hdr_t;
+typedef struct {
+    osal_event_hdr_t hdr;
+    uint8 state;
+    uint8 keys;
+} keyChange_t;
+extern uint8 RegisterForKeys(uint8 task_id);
+
+/*********************************************************************
+ * hal_adc.h
+ */
+#define HAL_ADC_RESOLUTION_8 0x01
+#define HAL_ADC_RESOLUTION_10 0x02
+#define HAL_ADC_RESOLUTION_12 0x03
+#define HAL_ADC_RESOLUTION_14 0x04
+
+#define HAL_ADC_REF_125V 0x00
+#define HAL_ADC_REF_AIN7 0x40
+#define HAL_ADC_REF_AVDD 0x80
+#define HAL_ADC_REF_DIFF 0xC0
+
+#define HAL_ADC_CHANNEL_VDD 0x0F
+
+extern uint16 HalAdcRead(uint8 channel, uint8 resolution);
+extern void HalAdcSetReference(uint8 reference);
+extern bool HalAdcCheckVdd(uint8 vdd);
+
+/*********************************************************************
+ * hal_dma.h, descriptor keeps host pointers instead of 16 bit XDATA addresses
+ */
+typedef struct {
+    volatile void *src;
+    void *dst;
+    uint16 len;
+} halDMADesc_t;
+extern halDMADesc_t sim_DmaDesc[5];
+
+#define HAL_DMA_GET_DESC0() (&sim_DmaDesc[0])
+#define HAL_DMA_GET_DESC1234(ch) (&sim_DmaDesc[(ch)])
+#define HAL_DMA_SET_ADDR_DESC0(a) st((void)(a);)
+#define HAL_DMA_SET_SOURCE(ch, a) st((ch)->src = (a);)
+#define HAL_DMA_SET_DEST(ch, a) st((ch)->dst = (a);)
+#define HAL_DMA_SET_LEN(ch, n) st((ch)->len = (n);)
+#define HAL_DMA_SET_VLEN(ch, v) st((void)(ch); (void)(v);)
+#define HAL_DMA_SET_WORD_SIZE(ch, v) st((void)(ch); (void)(v);)
+#define HAL_DMA_SET_TRIG_MODE(ch, v) st((void)(ch); (void)(v);)
+#define HAL_DMA_SET_TRIG_SRC(ch, v) st((void)(ch); (void)(v);)
+#define HAL_DMA_SET_SRC_INC(ch, v) st((void)(ch); (void)(v);)
+#define HAL_DMA_SET_DST_INC(ch, v) st((void)(ch); (void)(v);)
+#define HAL_DMA_SET_IRQ(ch, v) st((void)(ch); (void)(v);)
+#define HAL_DMA_SET_M8(ch, v) st((void)(ch); (void)(v);)
+#define HAL_DMA_SET_PRIORITY(ch, v) st((void)(ch); (void)(v);)
+#define HAL_DMA_CLEAR_IRQ(ch) st((void)(ch);)
+#define HAL_DMA_ARM_CH(ch) sim_DmaArm(ch)
+#define HAL_DMA_ABORT_CH(ch) st(DMAARM &= ~BV(ch);)
+extern void sim_DmaArm(uint8 ch);
+
+#define HAL_DMA_VLEN_USE_LEN 0
+#define HAL_DMA_WORDSIZE_WORD 1
+#define HAL_DMA_TMODE_SINGLE 0
+#define HAL_DMA_TRIG_ADC_CHALL 20
+#define HAL_DMA_SRCINC_0 0
+#define HAL_DMA_DSTINC_1 1
+#define HAL_DMA_IRQMASK_DISABLE 0
+#define HAL_DMA_M8_USE_8_BITS 0
+#define HAL_DMA_PRI_HIGH 2
+
+/*********************************************************************
+ * hal_flash.h, pages are kept in RAM, erased on start
+ */
+extern void HalFlashRead(uint8 pg, uint16 offset, uint8 *buf, uint16 cnt);
+extern void HalFlashWrite(uint16 addr, uint8 *buf, uint16 cnt);
+extern void HalFlashErase(uint8 pg);
+
+/*********************************************************************
+ * hal_led.h, hal_key.h
+ */
+#define HAL_LED_1 0x01
+#define HAL_LED_MODE_OFF 0x00
+#define HAL_LED_MODE_ON 0x01
+#define HAL_LED_MODE_BLINK 0x02
+extern uint8 HalLedSet(uint8 led, uint8 mode);
+
+#define HAL_KEY_PRESS 0x20
+#define HAL_KEY_RELEASE 0x40
+
+#endif /* SIM_HAL_H */
@@ -0,0 +1,316 @@
+#ifndef SIM_ZSTACK_H
+#define SIM_ZSTACK_H
+
+/**
+ * FYI: host stand-in for Z-Stack OSAL, ZDO, AF, NWK, ZCL and BDB headers, only what Source/ uses,
+ * values are the ones of Z-Stack 3.0.2. Functions are implemented by sim.c
+ * */
+
+#include "hal.h"
+
+/*********************************************************************
+ * ZComDef.h
+ */
+typedef uint8 ZStatus_t;
+typedef uint16 cId_t;
+typedef uint8 ZLongAddr_t[8];
+
+#define SUCCESS 0x00
+#define FAILURE 0x01
+#define ZSuccess 0x00
+#define ZFailure 0x01
+#define ZInvalidParameter 0x02
+#define NV_ITEM_UNINIT 0x09
+#define NV_OPER_FAILED 0x0A
+
+#define SYS_EVENT_MSG 0x8000
+#define AF_DATA_CONFIRM_CMD 0xFD
+#define ZDO_STATE_CHANGE 0xD1
+#define ZDO_CB_MSG 0xD3
+#define ZCL_INCOMING_MSG 0x34
+
+/*********************************************************************
+ * OSAL.h, OSAL_Timers.h, OSAL_Clock.h, OSAL_Nv.h, OSAL_PwrMgr.h
+ */
+#define PWRMGR_CONSERVE 0
+#define PWRMGR_HOLD 1
+
+extern uint8 *osal_msg_receive(uint8 task_id);
+extern uint8 osal_msg_deallocate(uint8 *msg_ptr);
+extern uint8 osal_set_event(uint8 task_id, uint16 event_flag);
+extern uint8 osal_start_timerEx(uint8 task_id, uint16 event_id, uint32 timeout_value);
+extern uint8 osal_start_reload_timer(uint8 taskID, uint16 event_id, uint32 timeout_value);
+extern uint8 osal_stop_timerEx(uint8 task_id, uint16 event_id);
+extern uint32 osal_GetSystemClock(void);
+extern uint32 osal_getClock(void);
+extern uint8 osal_pwrmgr_task_state(uint8 task_id, uint8 state);
+
+extern void *osal_mem_alloc(uint16 size);
+extern void osal_mem_free(void *ptr);
+extern void *osal_memcpy(void *dst, const void *src, unsigned int len);
+extern void *osal_memset(void *dest, uint8 value, int len);
+extern uint8 osal_memcmp(const void *src1, const void *src2, unsigned int len);
+extern uint8 *osal_buffer_uint32(uint8 *buf, uint32 val);
+
+extern uint8 osal_nv_item_init(uint16 id, uint16 len, void *buf);
+extern uint16 osal_nv_item_len(uint16 id);
+extern uint8 osal_nv_read(uint16 id, uint16 offset, uint16 len, void *buf);
+extern uint8 osal_nv_write(uint16 id, uint16 offset, uint16 len, void *buf);
+extern uint8 osal_nv_delete(uint16 id, uint16 len);
+
+/*********************************************************************
+ * AF.h
+ */
+typedef enum { afAddrNotPresent = 0, afAddrGroup = 1, afAddr16Bit = 2, afAddr64Bit = 3, afAddrBroadcast = 15 } afAddrMode_t;
+#define AddrNotPresent 0
+#define Addr16Bit 2
+
+typedef struct {
+    union {
+        uint16 shortAddr;
+        ZLongAddr_t extAddr;
+    } addr;
+    afAddrMode_t addrMode;
+    uint8 endPoint;
+    uint16 panId;
+} afAddrType_t;
+
+typedef struct {
+    uint8 EndPoint;
+    uint16 AppProfId;
+    uint16 AppDeviceId;
+    uint8 AppDevVer : 4;
+    uint8 Reserved : 4;
+    uint8 AppNumInClusters;
+    cId_t *pAppInClusterList;
+    uint8 AppNumOutClusters;
+    cId_t *pAppOutClusterList;
+} SimpleDescriptionFormat_t;
+
+typedef struct {
+    osal_event_hdr_t hdr;
+} afIncomingMSGPacket_t;
+
+typedef struct {
+    osal_event_hdr_t hdr;
+    uint8 endpoint;
+    uint8 transID;
+} afDataConfirm_t;
+
+/*********************************************************************
+ * ZDApp.h, ZDObject.h, ZGlobals.h, NLMEDE.h, nwk_util.h
+ */
+typedef enum {
+    DEV_HOLD,
+    DEV_INIT,
+    DEV_NWK_DISC,
+    DEV_NWK_JOINING,
+    DEV_NWK_SEC_REJOIN_CURR_CHANNEL,
+    DEV_END_DEVICE_UNAUTH,
+    DEV_END_DEVICE,
+    DEV_ROUTER,
+    DEV_COORD_STARTING,
+    DEV_ZB_COORD,
+    DEV_NWK_ORPHAN,
+    DEV_NWK_KA,
+    DEV_NWK_BACKOFF,
+    DEV_NWK_SEC_REJOIN_ALL_CHANNEL,
+    DEV_NWK_TC_REJOIN_CURR_CHANNEL,
+    DEV_NWK_TC_REJOIN_ALL_CHANNEL
+} devStates_t;
+
+#define Bind_req 0x0021
+#define Unbind_req 0x0022
+
+extern devStates_t devState;
+extern uint32 zgDefaultChannelList;
+extern uint32 zgPollRate;
+
+typedef struct {
+    uint8 nwkLogicalChannel;
+} nwkIB_t;
+extern nwkIB_t _NIB;
+
+extern ZStatus_t ZDO_RegisterForZDOMsg(uint8 taskID, uint16 clusterID);
+extern void NLME_SetPollRate(uint32 newRate);
+
+/*********************************************************************
+ * bdb.h, bdb_interface.h
+ */
+typedef struct {
+    bool bdbNodeIsOnANetwork;
+} bdbAttributes_t;
+extern bdbAttributes_t bdbAttributes;
+
+extern void bdb_RegisterSimpleDescriptor(SimpleDescriptionFormat_t *simpleDesc);
+extern ZStatus_t bdb_ZedAttemptRecoverNwk(void);
+extern uint8 bdb_getZCLFrameCounter(void);
+
+/*********************************************************************
+ * zcl.h, zcl_general.h, zcl_ms.h, zcl_ha.h, zcl_diagnostic.h
+ */
+#define ZCL_CLUSTER_ID_GEN_BASIC 0x0000
+#define ZCL_CLUSTER_ID_GEN_POWER_CFG 0x0001
+#define ZCL_CLUSTER_ID_GEN_POLL_CONTROL 0x0020
+#define ZCL_CLUSTER_ID_MS_ILLUMINANCE_MEASUREMENT 0x0400
+#define ZCL_CLUSTER_ID_MS_TEMPERATURE_MEASUREMENT 0x0402
+#define ZCL_CLUSTER_ID_MS_PRESSURE_MEASUREMENT 0x0403
+#define ZCL_CLUSTER_ID_MS_RELATIVE_HUMIDITY 0x0405
+#define ZCL_CLUSTER_ID_HA_DIAGNOSTIC 0x0B05
+
+#define ZCL_HA_PROFILE_ID 0x0104
+#define ZCL_HA_DEVICEID_SIMPLE_SENSOR 0x000C
+
+#define ZCL_DATATYPE_BOOLEAN 0x10
+#define ZCL_DATATYPE_INT8 0x28
+#define ZCL_DATATYPE_INT16 0x29
+#define ZCL_DATATYPE_UINT8 0x20
+#define ZCL_DATATYPE_UINT16 0x21
+#define ZCL_DATATYPE_UINT32 0x23
+#define ZCL_DATATYPE_ENUM8 0x30
+#define ZCL_DATATYPE_OCTET_STR 0x41
+#define ZCL_DATATYPE_CHAR_STR 0x42
+
+#define ACCESS_CONTROL_READ 0x01
+#define ACCESS_CONTROL_WRITE 0x02
+#define ACCESS_REPORTABLE 0x04
+#define ACCESS_CONTROL_AUTH_WRITE 0x40
+
+#define ZCL_OPER_LEN 0x00
+#define ZCL_OPER_READ 0x01
+#define ZCL_OPER_WRITE 0x02
+
+#define ZCL_STATUS_SUCCESS 0x00
+#define ZCL_STATUS_MALFORMED_COMMAND 0x80
+#define ZCL_STATUS_UNSUPPORTED_ATTRIBUTE 0x86
+#define ZCL_STATUS_INVALID_VALUE 0x87
+#define ZCL_STATUS_READ_ONLY 0x88
+#define ZCL_STATUS_SOFTWARE_FAILURE 0x01
+
+#define ZCL_FRAME_CLIENT_SERVER_DIR 0x00
+#define ZCL_FRAME_SERVER_CLIENT_DIR 0x01
+
+#define ATTRID_CLUSTER_REVISION 0xFFFD
+#define ATTRID_BASIC_ZCL_VERSION 0x0000
+#define ATTRID_BASIC_APPL_VERSION 0x0001
+#define ATTRID_BASIC_STACK_VERSION 0x0002
+#define ATTRID_BASIC_HW_VERSION 0x0003
+#define ATTRID_BASIC_MANUFACTURER_NAME 0x0004
+#define ATTRID_BASIC_MODEL_ID 0x0005
+#define ATTRID_BASIC_DATE_CODE 0x0006
+#define ATTRID_BASIC_POWER_SOURCE 0x0007
+#define ATTRID_BASIC_SW_BUILD_ID 0x4000
+#define POWER_SOURCE_BATTERY 0x03
+
+#define ATTRID_POWER_CFG_BATTERY_VOLTAGE 0x0020
+#define ATTRID_POWER_CFG_BATTERY_PERCENTAGE_REMAINING 0x0021
+#define ATTRID_POWER_CFG_BATTERY_VOLTAGE_RAW_ADC 0x0200
+
+#define ATTRID_POLL_CONTROL_CHECK_IN_INTERVAL 0x0000
+#define ATTRID_POLL_CONTROL_LONG_POLL_INTERVAL 0x0001
+#define ATTRID_POLL_CONTROL_SHORT_POLL_INTERVAL 0x0002
+#define ATTRID_POLL_CONTROL_FAST_POLL_TIMEOUT 0x0003
+#define COMMAND_POLL_CONTROL_CHECK_IN 0x00
+#define COMMAND_POLL_CONTROL_CHECK_IN_RESPONSE 0x00
+#define COMMAND_POLL_CONTROL_FAST_POLL_STOP 0x01
+#define COMMAND_POLL_CONTROL_SET_LONG_POLL_INTERVAL 0x02
+#define COMMAND_POLL_CONTROL_SET_SHORT_POLL_INTERVAL 0x03
+
+#define ATTRID_MS_ILLUMINANCE_MEASURED_VALUE 0x0000
+#define ATTRID_MS_TEMPERATURE_MEASURED_VALUE 0x0000
+#define ATTRID_MS_PRESSURE_MEASUREMENT_MEASURED_VALUE 0x0000
+#define ATTRID_MS_PRESSURE_MEASUREMENT_SCALED_VALUE 0x0010
+#define ATTRID_MS_PRESSURE_MEASUREMENT_SCALE 0x0014
+#define ATTRID_MS_RELATIVE_HUMIDITY_MEASURED_VALUE 0x0000
+
+typedef struct {
+    uint16 attrId;
+    uint8 dataType;
+    uint8 accessControl;
+    void *dataPtr;
+} zclAttribute_t;
+
+typedef struct {
+    uint16 clusterID;
+    zclAttribute_t attr;
+} zclAttrRec_t;
+
+typedef struct {
+    uint16 attrID;
+    uint8 dataType;
+    uint8 *attrData;
+} zclReport_t;
+
+typedef struct {
+    uint8 numAttr;
+    zclReport_t attrList[];
+} zclReportCmd_t;
+
+typedef struct {
+    uint16 attrID;
+    uint8 status;
+    uint8 dataType;
+    uint8 *attrData;
+} zclWriteRec_t;
+
+typedef struct {
+    unsigned int clusterSpecific : 2;
+    unsigned int manuSpecific : 1;
+    unsigned int direction : 1;
+    unsigned int disableDefaultRsp : 1;
+    unsigned int reserved : 3;
+} zclFrameControl_t;
+
+typedef struct {
+    zclFrameControl_t fc;
+    uint16 manuCode;
+    uint8 transSeqNum;
+    uint8 commandID;
+} zclFrameHdr_t;
+
+typedef struct {
+    afIncomingMSGPacket_t *msg;
+    zclFrameHdr_t hdr;
+    uint8 *pData;
+    uint16 pDataLen;
+    void *attrCmd;
+} zclIncoming_t;
+
+typedef struct {
+    osal_event_hdr_t hdr;
+    zclFrameHdr_t zclHdr;
+    uint16 clusterId;
+    afAddrType_t srcAddr;
+    uint8 endPoint;
+    void *attrCmd;
+} zclIncomingMsg_t;
+
+typedef ZStatus_t (*zclInHdlr_t)(zclIncoming_t *pInHdlrMsg);
+typedef ZStatus_t (*zclReadWriteCB_t)(uint16 clusterId, uint16 attrId, uint8 oper, uint8 *pValue, uint16 *pLen);
+typedef uint8 (*zclAuthorizeCB_t)(afAddrType_t *srcAddr, zclAttrRec_t *pAttr, uint8 oper);
+typedef uint8 (*zclValidateAttrData_t)(zclAttrRec_t *pAttr, zclWriteRec_t *pAttrInfo);
+
+typedef struct {
+    void *pfnBasicReset;
+    void *pfnIdentifyTriggerEffect;
+    void *pfnOnOff;
+    void *pfnOnOff_OffWithEffect;
+    void *pfnOnOff_OnWithRecallGlobalScene;
+    void *pfnOnOff_OnWithTimedOff;
+    void *pfnLocation;
+    void *pfnLocationRsp;
+} zclGeneral_AppCallbacks_t;
+
+extern ZStatus_t zclGeneral_RegisterCmdCallbacks(uint8 endpoint, zclGeneral_AppCallbacks_t *callbacks);
+extern ZStatus_t zcl_registerAttrList(uint8 endpoint, uint8 numAttr, CONST zclAttrRec_t attrList[]);
+extern ZStatus_t zcl_registerReadWriteCB(uint8 endpoint, zclReadWriteCB_t pfnReadWriteCB, zclAuthorizeCB_t pfnAuthorizeCB);
+extern uint8 zcl_registerValidateAttrData(zclValidateAttrData_t pfnValidateAttrData);
+extern ZStatus_t zcl_registerPlugin(uint16 startClusterID, uint16 endClusterID, zclInHdlr_t pfnIncomingHdlr);
+extern uint8 zcl_registerForMsg(uint8 taskId);
+extern uint8 zclFindAttrRec(uint8 endpoint, uint16 clusterID, uint16 attrId, zclAttrRec_t *pAttr);
+extern ZStatus_t zcl_SendReportCmd(uint8 srcEP, afAddrType_t *dstAddr, uint16 clusterID, zclReportCmd_t *reportCmd, uint8 direction,
+                                   uint8 disableDefaultRsp, uint8 seqNum);
+extern ZStatus_t zcl_SendCommand(uint8 srcEP, afAddrType_t *dstAddr, uint16 clusterID, uint8 cmd, uint8 specific, uint8 direction,
+                                 uint8 disableDefaultRsp, uint16 manuCode, uint8 seqNum, uint16 cmdFormatLen, uint8 *cmdFormat);
+
+#endif /* SIM_ZSTACK_H */
@@ -0,0 +1,27 @@
+#ifndef SIM_ZSTACK_LIB_H
+#define SIM_ZSTACK_LIB_H
+
+/**
+ * FYI: host stand-in for zstack-lib headers (Debug.h, battery.h, commissioning.h, factory_reset.h, utils.h),
+ * LREP goes to stdout when SIM_VERBOSE is set in environment
+ * */
+
+#include "hal.h"
+
+extern void sim_Log(const char *format, ...);
+#define LREP(...) sim_Log(__VA_ARGS__)
+#define LREPMaster(str) sim_Log(str)
+
+extern uint8 zclBattery_Voltage;
+extern uint8 zclBattery_PercentageRemainig;
+extern uint16 zclBattery_RawAdc;
+
+#define APP_COMMISSIONING_END_DEVICE_REJOIN_EVT 0x0002
+
+extern void zclCommissioning_Init(uint8 task_id);
+extern uint16 zclCommissioning_event_loop(uint8 task_id, uint16 events);
+extern void zclCommissioning_HandleKeys(uint8 portAndAction, uint8 keyCode);
+extern void zclFactoryResetter_Init(uint8 task_id);
+extern void zclFactoryResetter_HandleKeys(uint8 portAndAction, uint8 keyCode);
+
+#endif /* SIM_ZSTACK_LIB_H */
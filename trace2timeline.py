@@ -0,0 +1,122 @@
+import re
+import sys
+
+# usage:
+#   python trace2timeline.py uart.log        - lines "TRACE seq ticks event arg" printed by zclTrace_Dump
+#   python trace2timeline.py pages.txt       - hex of Diagnostics attributes 0x0210-0x0213, one page per line
+# see Source/trace.h for record layout and events
+
+TICKS_PER_SECOND = 32768
+TICKS_MASK = 0xFFFFFF
+RECORD_SIZE = 6
+
+EVENTS = {
+    0x01: 'cycle start',
+    0x02: 'cycle end',
+    0x03: 'wake',
+    0x04: 'sensors power',
+    0x05: 'excitation',
+    0x06: 'hold',
+    0x07: 'sensor start',
+    0x08: 'sensor read',
+    0x09: 'flush',
+    0x0A: 'rejoin',
+    0x0B: 'i2c',
+}
+SENSORS = ['DS18B20', 'BME280', 'ADC']
+SWITCHES = {0x04: 'sensors', 0x05: 'excitation', 0x06: 'hold', 0x0A: 'rejoin'}
+
+
+def parse_uart(line):
+    match = re.search(r'TRACE (\d+) (\d+) (\d+) (\d+)', line)
+    if match is None:
+        return []
+    seq, ticks, event, arg = [int(x) for x in match.groups()]
+    return [(seq, event, arg, ticks)]
+
+
+def parse_page(line):
+    data = bytes.fromhex(re.sub(r'[^0-9a-fA-F]', '', line))
+    if len(data) % RECORD_SIZE == 1:
+        # length byte of octet string
+        data = data[1:]
+    records = []
+    for i in range(0, len(data) - RECORD_SIZE + 1, RECORD_SIZE):
+        seq, event, arg = data[i], data[i + 1], data[i + 2]
+        ticks = data[i + 3] | data[i + 4] << 8 | data[i + 5] << 16
+        records.append((seq, event, arg, ticks))
+    return records
+
+
+def order(records, wrapped):
+    records = sorted(records)
+    if not wrapped or len(records) < 2:
+        return records
+    # page records carry only lower 8 bits of sequence, oldest one follows the largest gap
+    gaps = [(records[(i + 1) % len(records)][0] - records[i][0]) % 256 for i in range(len(records))]
+    first = (gaps.index(max(gaps)) + 1) % len(records)
+    return records[first:] + records[:first]
+
+
+def describe(event, arg):
+    name = EVENTS.get(event, 'event 0x%02X' % event)
+    if event in SWITCHES:
+        return '%s %s' % (name, 'on' if arg else 'off')
+    if event in (0x07, 0x08):
+        return '%s %s' % (name, SENSORS[arg] if arg < len(SENSORS) else arg)
+    if event == 0x09:
+        return '%s, %d frames' % (name, arg)
+    if event == 0x0B:
+        return '%s, %d transactions' % (name, arg)
+    return name
+
+
+def to_ms(ticks):
+    return (ticks & TICKS_MASK) * 1000.0 / TICKS_PER_SECOND
+
+
+def main():
+    records = []
+    wrapped = False
+    with open(sys.argv[1]) as fp:
+        for line in fp:
+            if 'TRACE' in line:
+                records += parse_uart(line)
+            elif line.strip():
+                records += parse_page(line)
+                wrapped = True
+    # never written slots
+    records = [r for r in records if r[1] != 0]
+    if not records:
+        print('no records')
+        return
+
+    start = None
+    previous = None
+    switched = {}
+    totals = {}
+    for seq, event, arg, ticks in order(records, wrapped):
+        if event == 0x01 or start is None:
+            if event == 0x01 and start is not None:
+                print()
+            start = ticks
+            previous = ticks
+            switched = {}
+            totals = {}
+        at = to_ms(ticks - start)
+        delta = to_ms(ticks - previous)
+        previous = ticks
+        print('%9.2f ms  +%8.2f ms  %s' % (at, delta, describe(event, arg)))
+
+        if event in SWITCHES:
+            name = SWITCHES[event]
+            if arg:
+                switched[name] = ticks
+            elif name in switched:
+                totals[name] = totals.get(name, 0) + to_ms(ticks - switched.pop(name))
+        if event == 0x02:
+            print('cycle %.2f ms, %s' % (at, ', '.join('%s %.2f ms' % (k, v) for k, v in sorted(totals.items()))))
+
+
+if __name__ == '__main__':
+    main()